@@ -0,0 +1,281 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "phase-report.h"
+#include "idioms.h"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <sys/resource.h>
+
+namespace Fortran::common {
+
+AllocationCounts allocationCounts;
+
+// The peak resident set size of this process so far, in KiB
+static long PeakRSS() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;  // bytes
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+PhaseReport::Timer::Timer(PhaseReport *report, std::string phase)
+  : report_{report}, phase_{std::move(phase)} {
+  if (report_ != nullptr) {
+    if (std::find(report_->active_.begin(), report_->active_.end(), phase_) !=
+        report_->active_.end()) {
+      report_ = nullptr;  // recursive; the outermost Timer measures it
+    } else {
+      // Claim the phase's row now so that it precedes any nested phases.
+      report_->Find(phase_, static_cast<int>(report_->active_.size()));
+      report_->active_.push_back(phase_);
+      allocationsAtStart_ = allocationCounts;
+      wallStart_ = std::chrono::steady_clock::now();
+      cpuStart_ = std::clock();
+    }
+  }
+}
+
+PhaseReport::Timer::~Timer() {
+  if (report_ != nullptr) {
+    Measurement m;
+    m.count = 1;
+    m.cpuSeconds =
+        static_cast<double>(std::clock() - cpuStart_) / CLOCKS_PER_SEC;
+    m.wallSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wallStart_)
+                        .count();
+    m.allocations =
+        allocationCounts.allocations - allocationsAtStart_.allocations;
+    m.allocatedBytes =
+        allocationCounts.allocatedBytes - allocationsAtStart_.allocatedBytes;
+    m.retainedBytes = static_cast<std::int64_t>(allocationCounts.liveBytes) -
+        static_cast<std::int64_t>(allocationsAtStart_.liveBytes);
+    m.peakRSS = PeakRSS();
+    CHECK(!report_->active_.empty() && report_->active_.back() == phase_);
+    report_->active_.pop_back();
+    report_->Add(phase_, static_cast<int>(report_->active_.size()), m);
+  }
+}
+
+void PhaseReport::Stopwatch::Start() {
+  allocationsAtStart_ = allocationCounts.allocations;
+  allocatedBytesAtStart_ = allocationCounts.allocatedBytes;
+  liveBytesAtStart_ = allocationCounts.liveBytes;
+  wallStart_ = std::chrono::steady_clock::now();
+  cpuStart_ = std::clock();
+}
+
+void PhaseReport::Stopwatch::Stop() {
+  measurement_.cpuSeconds +=
+      static_cast<double>(std::clock() - cpuStart_) / CLOCKS_PER_SEC;
+  measurement_.wallSeconds += std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - wallStart_)
+                                  .count();
+  measurement_.allocations +=
+      allocationCounts.allocations - allocationsAtStart_;
+  measurement_.allocatedBytes +=
+      allocationCounts.allocatedBytes - allocatedBytesAtStart_;
+  measurement_.retainedBytes +=
+      static_cast<std::int64_t>(allocationCounts.liveBytes) -
+      static_cast<std::int64_t>(liveBytesAtStart_);
+}
+
+void PhaseReport::Stopwatch::Report(
+    PhaseReport &report, const std::string &phase) const {
+  Measurement m{measurement_};
+  m.count = 1;
+  m.peakRSS = PeakRSS();
+  report.Add(phase, static_cast<int>(report.active_.size()), m);
+}
+
+void PhaseReport::Add(
+    const std::string &phase, int depth, const Measurement &m) {
+  Phase &p{Find(phase, depth)};
+  p.measurement.count += m.count;
+  p.measurement.wallSeconds += m.wallSeconds;
+  p.measurement.cpuSeconds += m.cpuSeconds;
+  p.measurement.allocations += m.allocations;
+  p.measurement.allocatedBytes += m.allocatedBytes;
+  p.measurement.retainedBytes += m.retainedBytes;
+  p.measurement.peakRSS = std::max(p.measurement.peakRSS, m.peakRSS);
+}
+
+void PhaseReport::AddSize(
+    const std::string &structure, std::size_t objects, std::size_t bytes) {
+  auto iter{std::find_if(sizes_.begin(), sizes_.end(),
+      [&](const Size &x) { return x.name == structure; })};
+  if (iter == sizes_.end()) {
+    sizes_.push_back(Size{structure, objects, bytes});
+  } else if (bytes > iter->bytes) {
+    iter->objects = objects;
+    iter->bytes = bytes;
+  }
+}
+
+PhaseReport::Phase &PhaseReport::Find(const std::string &phase, int depth) {
+  auto iter{std::find_if(phases_.begin(), phases_.end(),
+      [&](const Phase &p) { return p.name == phase; })};
+  if (iter == phases_.end()) {
+    phases_.push_back(Phase{phase, depth, Measurement{}});
+    return phases_.back();
+  } else {
+    return *iter;
+  }
+}
+
+void PhaseReport::Merge(const PhaseReport &that) {
+  for (const Phase &phase : that.phases_) {
+    Add(phase.name, phase.depth, phase.measurement);
+  }
+  for (const Size &size : that.sizes_) {
+    AddSize(size.name, size.objects, size.bytes);
+  }
+}
+
+static std::size_t Indentation(int depth) {
+  return 2 * static_cast<std::size_t>(depth);
+}
+
+std::ostream &PhaseReport::Dump(std::ostream &o) const {
+  std::size_t width{5};
+  for (const Phase &phase : phases_) {
+    width = std::max(width, Indentation(phase.depth) + phase.name.size());
+  }
+  o << std::left << std::setw(width) << "Phase" << std::right << std::setw(8)
+    << "Count" << std::setw(12) << "Wall (s)" << std::setw(12) << "CPU (s)"
+    << '\n';
+  for (const Phase &phase : phases_) {
+    std::size_t indentation{Indentation(phase.depth)};
+    o << std::string(indentation, ' ') << std::left
+      << std::setw(width - indentation) << phase.name << std::right
+      << std::setw(8) << phase.measurement.count << std::fixed
+      << std::setprecision(4) << std::setw(12) << phase.measurement.wallSeconds
+      << std::setw(12) << phase.measurement.cpuSeconds << '\n';
+  }
+  return o << std::defaultfloat;
+}
+
+std::ostream &PhaseReport::DumpMemory(std::ostream &o) const {
+  constexpr std::size_t KiB{1024};
+  std::size_t width{9};
+  for (const Phase &phase : phases_) {
+    width = std::max(width, Indentation(phase.depth) + phase.name.size());
+  }
+  for (const Size &size : sizes_) {
+    width = std::max(width, size.name.size());
+  }
+  o << std::left << std::setw(width) << "Phase" << std::right << std::setw(8)
+    << "Count" << std::setw(12) << "Allocs" << std::setw(16)
+    << "Alloc'd (KiB)" << std::setw(16) << "Retained (KiB)" << std::setw(16)
+    << "Peak RSS (KiB)" << '\n';
+  for (const Phase &phase : phases_) {
+    const Measurement &m{phase.measurement};
+    std::size_t indentation{Indentation(phase.depth)};
+    o << std::string(indentation, ' ') << std::left
+      << std::setw(width - indentation) << phase.name << std::right
+      << std::setw(8) << m.count << std::setw(12) << m.allocations
+      << std::setw(16) << m.allocatedBytes / KiB << std::setw(16)
+      << m.retainedBytes / static_cast<std::int64_t>(KiB) << std::setw(16)
+      << m.peakRSS << '\n';
+  }
+  if (!sizes_.empty()) {
+    o << '\n'
+      << std::left << std::setw(width) << "Structure" << std::right
+      << std::setw(12) << "Objects" << std::setw(16) << "Size (KiB)" << '\n';
+    for (const Size &size : sizes_) {
+      o << std::left << std::setw(width) << size.name << std::right
+        << std::setw(12) << size.objects << std::setw(16) << size.bytes / KiB
+        << '\n';
+    }
+  }
+  return o;
+}
+
+std::ostream &PhaseReport::DumpJSON(std::ostream &o) const {
+  o << "{\"phases\": [";
+  const char *separator{"\n"};
+  for (const Phase &phase : phases_) {
+    o << separator << "  {\"name\": \"" << phase.name
+      << "\", \"depth\": " << phase.depth
+      << ", \"count\": " << phase.measurement.count
+      << ", \"wall\": " << phase.measurement.wallSeconds
+      << ", \"cpu\": " << phase.measurement.cpuSeconds
+      << ", \"allocations\": " << phase.measurement.allocations
+      << ", \"allocated\": " << phase.measurement.allocatedBytes
+      << ", \"retained\": " << phase.measurement.retainedBytes
+      << ", \"peakRSSKiB\": " << phase.measurement.peakRSS << '}';
+    separator = ",\n";
+  }
+  o << "\n], \"structures\": [";
+  separator = "\n";
+  for (const Size &size : sizes_) {
+    o << separator << "  {\"name\": \"" << size.name
+      << "\", \"objects\": " << size.objects << ", \"bytes\": " << size.bytes
+      << '}';
+    separator = ",\n";
+  }
+  return o << "\n]}\n";
+}
+
+std::string PhaseReport::Serialize() const {
+  std::stringstream ss;
+  ss << std::setprecision(17);
+  for (const Phase &phase : phases_) {
+    const Measurement &m{phase.measurement};
+    ss << "phase " << phase.depth << ' ' << m.count << ' ' << m.wallSeconds
+       << ' ' << m.cpuSeconds << ' ' << m.allocations << ' '
+       << m.allocatedBytes << ' ' << m.retainedBytes << ' ' << m.peakRSS
+       << ' ' << phase.name << '\n';
+  }
+  for (const Size &size : sizes_) {
+    ss << "size " << size.objects << ' ' << size.bytes << ' ' << size.name
+       << '\n';
+  }
+  return ss.str();
+}
+
+void PhaseReport::Deserialize(const std::string &text) {
+  PhaseReport that;
+  std::stringstream ss{text};
+  std::string kind;
+  while (ss >> kind) {
+    if (kind == "phase") {
+      Phase phase;
+      Measurement &m{phase.measurement};
+      ss >> phase.depth >> m.count >> m.wallSeconds >> m.cpuSeconds >>
+          m.allocations >> m.allocatedBytes >> m.retainedBytes >> m.peakRSS;
+      ss.get();  // the space before the name
+      std::getline(ss, phase.name);
+      that.phases_.push_back(phase);
+    } else if (kind == "size") {
+      Size size;
+      ss >> size.objects >> size.bytes;
+      ss.get();
+      std::getline(ss, size.name);
+      that.sizes_.push_back(size);
+    } else {
+      break;
+    }
+  }
+  Merge(that);
+}
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FORTRAN_COMMON_PHASE_REPORT_H_
+#define FORTRAN_COMMON_PHASE_REPORT_H_
+
+// Accumulates the wall clock and CPU times, heap allocations, and peak
+// resident set sizes of the named phases of one or more compilations
+// (-ftime-report, -fmemory-report).  Phases may nest; a phase is reported
+// at the depth at which it was first measured.  The sizes of the principal
+// data structures of a compilation may also be recorded.
+//
+// common::PhaseReport report;
+// {
+//   common::PhaseReport::Timer timer{&report, "ResolveNames"};
+//   ...
+// }
+// report.Dump(std::cerr);
+//
+// A Timer built with a null PhaseReport pointer does nothing, so code
+// can be instrumented unconditionally.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Fortran::common {
+
+// Counts of heap allocations, maintained by a program that replaces the
+// global operator new and delete (as f18 does); all zero otherwise.
+// Threads parsing in parallel allocate concurrently, so the counts are
+// atomic; they are only ever summed, so their updates can be relaxed.
+struct AllocationCounts {
+  AllocationCounts() {}
+  AllocationCounts(const AllocationCounts &that) { *this = that; }
+  AllocationCounts &operator=(const AllocationCounts &that) {
+    allocations = that.allocations.load(std::memory_order_relaxed);
+    allocatedBytes = that.allocatedBytes.load(std::memory_order_relaxed);
+    liveBytes = that.liveBytes.load(std::memory_order_relaxed);
+    return *this;
+  }
+  std::atomic<std::size_t> allocations{0}, allocatedBytes{0};
+  std::atomic<std::size_t> liveBytes{0};  // when a freed block's size is known
+};
+extern AllocationCounts allocationCounts;
+
+class PhaseReport {
+public:
+  struct Measurement {
+    int count{0};
+    double wallSeconds{0}, cpuSeconds{0};
+    std::size_t allocations{0}, allocatedBytes{0};
+    std::int64_t retainedBytes{0};  // net growth of the heap; can be < 0
+    long peakRSS{0};  // KiB; the largest seen at the end of the phase
+  };
+
+  class Timer {
+  public:
+    Timer(PhaseReport *, std::string phase);
+    Timer(const Timer &) = delete;
+    ~Timer();
+
+  private:
+    PhaseReport *report_;
+    std::string phase_;
+    std::chrono::steady_clock::time_point wallStart_;
+    std::clock_t cpuStart_;
+    AllocationCounts allocationsAtStart_;
+  };
+
+  // Accumulates the times and allocations of many brief intervals, such
+  // as the calls to one checker during a walk of the parse tree, more
+  // cheaply than a Timer for each would; Report() adds them to a report as
+  // one phase nested within its running Timers.
+  class Stopwatch {
+  public:
+    void Start();
+    void Stop();
+    void Report(PhaseReport &, const std::string &phase) const;
+
+  private:
+    Measurement measurement_;
+    std::chrono::steady_clock::time_point wallStart_;
+    std::clock_t cpuStart_;
+    std::size_t allocationsAtStart_, allocatedBytesAtStart_;
+    std::size_t liveBytesAtStart_;
+  };
+
+  // Measures a call to f() as a phase and returns its result.
+  template<typename F>
+  static auto Measure(PhaseReport *report, const char *phase, F &&f) {
+    Timer timer{report, phase};
+    return f();
+  }
+
+  bool empty() const { return phases_.empty(); }
+  void Add(const std::string &phase, int depth, const Measurement &);
+  // Records the size of a data structure; the largest one is reported.
+  void AddSize(
+      const std::string &structure, std::size_t objects, std::size_t bytes);
+  void Merge(const PhaseReport &);
+
+  // Human-readable tables of times or of memory use, or JSON with both
+  std::ostream &Dump(std::ostream &) const;
+  std::ostream &DumpMemory(std::ostream &) const;
+  std::ostream &DumpJSON(std::ostream &) const;
+
+  // A simple line-oriented text form used to pass a report from a
+  // child process back to its parent
+  std::string Serialize() const;
+  void Deserialize(const std::string &);
+
+private:
+  struct Phase {
+    std::string name;
+    int depth;
+    Measurement measurement;
+  };
+
+  struct Size {
+    std::string name;
+    std::size_t objects, bytes;
+  };
+
+  Phase &Find(const std::string &, int depth);
+
+  std::vector<Phase> phases_;  // in order of first measurement
+  std::vector<Size> sizes_;
+  std::vector<std::string> active_;  // the nest of running Timers
+};
+}
+#endif  // FORTRAN_COMMON_PHASE_REPORT_H_
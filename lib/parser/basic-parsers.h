@@ -95,12 +95,12 @@ public:
   constexpr BacktrackingParser(const A &parser) : parser_{parser} {}
   std::optional<resultType> Parse(ParseState &state) const {
     Messages messages{std::move(state.messages())};
-    ParseState backtrack{state};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
     std::optional<resultType> result{parser_.Parse(state)};
     if (result.has_value()) {
       state.messages().Restore(std::move(messages));
     } else {
-      state = std::move(backtrack);
+      state.Rollback(backtrack);
       state.messages() = std::move(messages);
     }
     return result;
@@ -122,9 +122,13 @@ public:
   constexpr NegatedParser(const NegatedParser &) = default;
   constexpr NegatedParser(PA p) : parser_{p} {}
   std::optional<Success> Parse(ParseState &state) const {
-    ParseState forked{state};
-    forked.set_deferMessages(true);
-    if (parser_.Parse(forked)) {
+    Messages messages{std::move(state.messages())};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
+    state.set_deferMessages(true);
+    bool matched{parser_.Parse(state).has_value()};
+    state.Rollback(backtrack);
+    state.messages() = std::move(messages);
+    if (matched) {
       return std::nullopt;
     }
     return {Success{}};
@@ -146,9 +150,13 @@ public:
   constexpr LookAheadParser(const LookAheadParser &) = default;
   constexpr LookAheadParser(PA p) : parser_{p} {}
   std::optional<Success> Parse(ParseState &state) const {
-    ParseState forked{state};
-    forked.set_deferMessages(true);
-    if (parser_.Parse(forked)) {
+    Messages messages{std::move(state.messages())};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
+    state.set_deferMessages(true);
+    bool matched{parser_.Parse(state).has_value()};
+    state.Rollback(backtrack);
+    state.messages() = std::move(messages);
+    if (matched) {
       return {Success{}};
     }
     return std::nullopt;
@@ -171,7 +179,8 @@ public:
   constexpr MessageContextParser(MessageFixedText t, PA p)
     : text_{t}, parser_{p} {}
   std::optional<resultType> Parse(ParseState &state) const {
-    state.PushContext(text_);
+    ParseContext context{text_};
+    state.PushContext(context);
     std::optional<resultType> result{parser_.Parse(state)};
     state.PopContext();
     return result;
@@ -198,22 +207,24 @@ public:
     : text_{t}, parser_{p} {}
   std::optional<resultType> Parse(ParseState &state) const {
     Messages messages{std::move(state.messages())};
-    ParseState backtrack{state};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
+    bool anyTokenMatched{state.anyTokenMatched()};
     state.set_anyTokenMatched(false);
     std::optional<resultType> result{parser_.Parse(state)};
     bool emitMessage{false};
     if (result.has_value()) {
       messages.Annex(std::move(state.messages()));
-      if (backtrack.anyTokenMatched()) {
+      if (anyTokenMatched) {
         state.set_anyTokenMatched();
       }
     } else if (state.anyTokenMatched()) {
       messages.Annex(std::move(state.messages()));
-      backtrack.set_anyTokenMatched();
-      if (state.anyDeferredMessages()) {
-        backtrack.set_anyDeferredMessages(true);
+      bool anyDeferredMessages{state.anyDeferredMessages()};
+      state.Rollback(backtrack);
+      state.set_anyTokenMatched();
+      if (anyDeferredMessages) {
+        state.set_anyDeferredMessages(true);
       }
-      state = std::move(backtrack);
     } else {
       emitMessage = true;
     }
@@ -292,7 +303,7 @@ public:
   constexpr AlternativesParser(const AlternativesParser &) = default;
   std::optional<resultType> Parse(ParseState &state) const {
     Messages messages{std::move(state.messages())};
-    ParseState backtrack{state};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
     std::optional<resultType> result{std::get<0>(ps_).Parse(state)};
     if constexpr (sizeof...(Ps) > 0) {
       if (!result.has_value()) {
@@ -306,12 +317,13 @@ public:
 private:
   template<int J>
   void ParseRest(std::optional<resultType> &result, ParseState &state,
-      ParseState &backtrack) const {
-    ParseState prevState{std::move(state)};
-    state = backtrack;
+      const ParseState::Checkpoint &backtrack) const {
+    ParseState::Checkpoint prev{state.MakeCheckpoint()};
+    Messages prevMessages{std::move(state.messages())};
+    state.Rollback(backtrack);
     result = std::get<J>(ps_).Parse(state);
     if (!result.has_value()) {
-      state.CombineFailedParses(std::move(prevState));
+      state.CombineFailedParses(prev, std::move(prevMessages));
       if constexpr (J < sizeof...(Ps)) {
         ParseRest<J + 1>(result, state, backtrack);
       }
@@ -342,7 +354,7 @@ public:
   constexpr RecoveryParser(PA pa, PB pb) : pa_{pa}, pb_{pb} {}
   std::optional<resultType> Parse(ParseState &state) const {
     bool originallyDeferred{state.deferMessages()};
-    ParseState backtrack{state};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
     if (!originallyDeferred && state.messages().empty() &&
         !state.anyErrorRecovery()) {
       // Fast path.  There are no messages or recovered errors in the incoming
@@ -355,7 +367,7 @@ public:
           return ax;
         }
       }
-      state = backtrack;
+      state.Rollback(backtrack);
     }
     Messages messages{std::move(state.messages())};
     if (std::optional<resultType> ax{pa_.Parse(state)}) {
@@ -365,7 +377,7 @@ public:
     messages.Annex(std::move(state.messages()));
     bool hadDeferredMessages{state.anyDeferredMessages()};
     bool anyTokenMatched{state.anyTokenMatched()};
-    state = std::move(backtrack);
+    state.Rollback(backtrack);
     state.set_deferMessages(true);
     std::optional<resultType> bx{pb_.Parse(state)};
     state.messages() = std::move(messages);
@@ -24,7 +24,7 @@ std::optional<Success> DebugParser::Parse(ParseState &state) const {
     if (auto out{ustate->debugOutput()}) {
       std::string note{str_, length_};
       Message message{state.GetLocation(), "parser debug: %s"_en_US, note};
-      message.SetContext(state.context().get());
+      message.SetContext(state.ContextMessage());
       message.Emit(*out, ustate->cooked(), true);
     }
   }
@@ -130,28 +130,51 @@ TYPE_CONTEXT_PARSER("specification construct"_en_US,
 //        intent-stmt | intrinsic-stmt | namelist-stmt | optional-stmt |
 //        pointer-stmt | protected-stmt | save-stmt | target-stmt |
 //        volatile-stmt | value-stmt | common-stmt | equivalence-stmt
-TYPE_PARSER(first(
-    construct<OtherSpecificationStmt>(indirect(Parser<AccessStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<AllocatableStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<AsynchronousStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<BindStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<CodimensionStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<ContiguousStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<DimensionStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<ExternalStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<IntentStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<IntrinsicStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<NamelistStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<OptionalStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<PointerStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<ProtectedStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<SaveStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<TargetStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<ValueStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<VolatileStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<CommonStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<EquivalenceStmt>{})),
-    construct<OtherSpecificationStmt>(indirect(Parser<BasedPointerStmt>{}))))
+TYPE_PARSER(dispatch(
+    startingWith("p"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<AccessStmt>{}))),
+    startingWith("a"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<AllocatableStmt>{}))),
+    startingWith("a"_ch,
+        construct<OtherSpecificationStmt>(
+            indirect(Parser<AsynchronousStmt>{}))),
+    startingWith("b"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<BindStmt>{}))),
+    startingWith("c"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<CodimensionStmt>{}))),
+    startingWith("c"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<ContiguousStmt>{}))),
+    startingWith("d"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<DimensionStmt>{}))),
+    startingWith("e"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<ExternalStmt>{}))),
+    startingWith("i"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<IntentStmt>{}))),
+    startingWith("i"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<IntrinsicStmt>{}))),
+    startingWith("n"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<NamelistStmt>{}))),
+    startingWith("o"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<OptionalStmt>{}))),
+    startingWith("p"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<PointerStmt>{}))),
+    startingWith("p"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<ProtectedStmt>{}))),
+    startingWith("s"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<SaveStmt>{}))),
+    startingWith("t"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<TargetStmt>{}))),
+    startingWith("v"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<ValueStmt>{}))),
+    startingWith("v"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<VolatileStmt>{}))),
+    startingWith("c"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<CommonStmt>{}))),
+    startingWith("e"_ch,
+        construct<OtherSpecificationStmt>(indirect(Parser<EquivalenceStmt>{}))),
+    startingWith("p"_ch,
+        construct<OtherSpecificationStmt>(
+            indirect(Parser<BasedPointerStmt>{})))))
 
 // R604 constant ->  literal-constant | named-constant
 // Used only via R607 int-constant and R845 data-stmt-constant.
@@ -275,10 +298,10 @@ constexpr auto scalarIntConstantExpr{scalar(intConstantExpr)};
 // Consequently, a program unit END statement should be the last statement
 // on its line.  We parse those END statements via unterminatedStatement()
 // and then skip over the end of the line here.
-TYPE_PARSER(construct<Program>(some(StartNewSubprogram{} >>
-                Parser<ProgramUnit>{} / skipMany(";"_tok) / space /
-                    recovery(endOfLine, SkipPast<'\n'>{}))) /
-    skipStuffBeforeStatement)
+constexpr auto programUnitLines{StartNewSubprogram{} >> Parser<ProgramUnit>{} /
+    skipMany(";"_tok) / space / recovery(endOfLine, SkipPast<'\n'>{})};
+TYPE_PARSER(
+    construct<Program>(some(programUnitLines)) / skipStuffBeforeStatement)
 
 // R502 program-unit ->
 //        main-program | external-subprogram | module | submodule | block-data
@@ -363,47 +386,86 @@ TYPE_CONTEXT_PARSER("internal subprogram part"_en_US,
 //        wait-stmt | where-stmt | write-stmt | computed-goto-stmt | forall-stmt
 // R1159 continue-stmt -> CONTINUE
 // R1163 fail-image-stmt -> FAIL IMAGE
-TYPE_PARSER(first(construct<ActionStmt>(indirect(Parser<AllocateStmt>{})),
-    construct<ActionStmt>(indirect(assignmentStmt)),
-    construct<ActionStmt>(indirect(pointerAssignmentStmt)),
-    construct<ActionStmt>(indirect(Parser<BackspaceStmt>{})),
-    construct<ActionStmt>(indirect(Parser<CallStmt>{})),
-    construct<ActionStmt>(indirect(Parser<CloseStmt>{})),
-    construct<ActionStmt>(construct<ContinueStmt>("CONTINUE"_tok)),
-    construct<ActionStmt>(indirect(Parser<CycleStmt>{})),
-    construct<ActionStmt>(indirect(Parser<DeallocateStmt>{})),
-    construct<ActionStmt>(indirect(Parser<EndfileStmt>{})),
-    construct<ActionStmt>(indirect(Parser<EventPostStmt>{})),
-    construct<ActionStmt>(indirect(Parser<EventWaitStmt>{})),
-    construct<ActionStmt>(indirect(Parser<ExitStmt>{})),
-    construct<ActionStmt>(construct<FailImageStmt>("FAIL IMAGE"_sptok)),
-    construct<ActionStmt>(indirect(Parser<FlushStmt>{})),
-    construct<ActionStmt>(indirect(Parser<FormTeamStmt>{})),
-    construct<ActionStmt>(indirect(Parser<GotoStmt>{})),
-    construct<ActionStmt>(indirect(Parser<IfStmt>{})),
-    construct<ActionStmt>(indirect(Parser<InquireStmt>{})),
-    construct<ActionStmt>(indirect(Parser<LockStmt>{})),
-    construct<ActionStmt>(indirect(Parser<NullifyStmt>{})),
-    construct<ActionStmt>(indirect(Parser<OpenStmt>{})),
-    construct<ActionStmt>(indirect(Parser<PrintStmt>{})),
-    construct<ActionStmt>(indirect(Parser<ReadStmt>{})),
-    construct<ActionStmt>(indirect(Parser<ReturnStmt>{})),
-    construct<ActionStmt>(indirect(Parser<RewindStmt>{})),
-    construct<ActionStmt>(indirect(Parser<StopStmt>{})),  // & error-stop-stmt
-    construct<ActionStmt>(indirect(Parser<SyncAllStmt>{})),
-    construct<ActionStmt>(indirect(Parser<SyncImagesStmt>{})),
-    construct<ActionStmt>(indirect(Parser<SyncMemoryStmt>{})),
-    construct<ActionStmt>(indirect(Parser<SyncTeamStmt>{})),
-    construct<ActionStmt>(indirect(Parser<UnlockStmt>{})),
-    construct<ActionStmt>(indirect(Parser<WaitStmt>{})),
-    construct<ActionStmt>(indirect(whereStmt)),
-    construct<ActionStmt>(indirect(Parser<WriteStmt>{})),
-    construct<ActionStmt>(indirect(Parser<ComputedGotoStmt>{})),
-    construct<ActionStmt>(indirect(forallStmt)),
-    construct<ActionStmt>(indirect(Parser<ArithmeticIfStmt>{})),
-    construct<ActionStmt>(indirect(Parser<AssignStmt>{})),
-    construct<ActionStmt>(indirect(Parser<AssignedGotoStmt>{})),
-    construct<ActionStmt>(indirect(Parser<PauseStmt>{}))))
+TYPE_PARSER(memoized("action-stmt"_en_US,
+    dispatch(startingWith("a"_ch,
+                 construct<ActionStmt>(indirect(Parser<AllocateStmt>{}))),
+        construct<ActionStmt>(indirect(assignmentStmt)),
+        construct<ActionStmt>(indirect(pointerAssignmentStmt)),
+        startingWith("b"_ch,
+            construct<ActionStmt>(indirect(Parser<BackspaceStmt>{}))),
+        startingWith("c"_ch,
+            construct<ActionStmt>(indirect(Parser<CallStmt>{}))),
+        startingWith("c"_ch,
+            construct<ActionStmt>(indirect(Parser<CloseStmt>{}))),
+        startingWith("c"_ch,
+            construct<ActionStmt>(construct<ContinueStmt>("CONTINUE"_tok))),
+        startingWith("c"_ch,
+            construct<ActionStmt>(indirect(Parser<CycleStmt>{}))),
+        startingWith("d"_ch,
+            construct<ActionStmt>(indirect(Parser<DeallocateStmt>{}))),
+        startingWith("e"_ch,
+            construct<ActionStmt>(indirect(Parser<EndfileStmt>{}))),
+        startingWith("e"_ch,
+            construct<ActionStmt>(indirect(Parser<EventPostStmt>{}))),
+        startingWith("e"_ch,
+            construct<ActionStmt>(indirect(Parser<EventWaitStmt>{}))),
+        startingWith("e"_ch,
+            construct<ActionStmt>(indirect(Parser<ExitStmt>{}))),
+        startingWith("f"_ch,
+            construct<ActionStmt>(
+                construct<FailImageStmt>("FAIL IMAGE"_sptok))),
+        startingWith("f"_ch,
+            construct<ActionStmt>(indirect(Parser<FlushStmt>{}))),
+        startingWith("f"_ch,
+            construct<ActionStmt>(indirect(Parser<FormTeamStmt>{}))),
+        startingWith("g"_ch,
+            construct<ActionStmt>(indirect(Parser<GotoStmt>{}))),
+        startingWith("i"_ch, construct<ActionStmt>(indirect(Parser<IfStmt>{}))),
+        startingWith("i"_ch,
+            construct<ActionStmt>(indirect(Parser<InquireStmt>{}))),
+        startingWith("l"_ch,
+            construct<ActionStmt>(indirect(Parser<LockStmt>{}))),
+        startingWith("n"_ch,
+            construct<ActionStmt>(indirect(Parser<NullifyStmt>{}))),
+        startingWith("o"_ch,
+            construct<ActionStmt>(indirect(Parser<OpenStmt>{}))),
+        startingWith("p"_ch,
+            construct<ActionStmt>(indirect(Parser<PrintStmt>{}))),
+        startingWith("r"_ch,
+            construct<ActionStmt>(indirect(Parser<ReadStmt>{}))),
+        startingWith("r"_ch,
+            construct<ActionStmt>(indirect(Parser<ReturnStmt>{}))),
+        startingWith("r"_ch,
+            construct<ActionStmt>(indirect(Parser<RewindStmt>{}))),
+        // stop-stmt & error-stop-stmt
+        startingWith("es"_ch,
+            construct<ActionStmt>(indirect(Parser<StopStmt>{}))),
+        startingWith("s"_ch,
+            construct<ActionStmt>(indirect(Parser<SyncAllStmt>{}))),
+        startingWith("s"_ch,
+            construct<ActionStmt>(indirect(Parser<SyncImagesStmt>{}))),
+        startingWith("s"_ch,
+            construct<ActionStmt>(indirect(Parser<SyncMemoryStmt>{}))),
+        startingWith("s"_ch,
+            construct<ActionStmt>(indirect(Parser<SyncTeamStmt>{}))),
+        startingWith("u"_ch,
+            construct<ActionStmt>(indirect(Parser<UnlockStmt>{}))),
+        startingWith("w"_ch,
+            construct<ActionStmt>(indirect(Parser<WaitStmt>{}))),
+        startingWith("w"_ch, construct<ActionStmt>(indirect(whereStmt))),
+        startingWith("w"_ch,
+            construct<ActionStmt>(indirect(Parser<WriteStmt>{}))),
+        startingWith("g"_ch,
+            construct<ActionStmt>(indirect(Parser<ComputedGotoStmt>{}))),
+        startingWith("f"_ch, construct<ActionStmt>(indirect(forallStmt))),
+        startingWith("i"_ch,
+            construct<ActionStmt>(indirect(Parser<ArithmeticIfStmt>{}))),
+        startingWith("a"_ch,
+            construct<ActionStmt>(indirect(Parser<AssignStmt>{}))),
+        startingWith("g"_ch,
+            construct<ActionStmt>(indirect(Parser<AssignedGotoStmt>{}))),
+        startingWith("p"_ch,
+            construct<ActionStmt>(indirect(Parser<PauseStmt>{}))))))
 
 // Fortran allows the statement with the corresponding label at the end of
 // a do-construct that begins with an old-style label-do-stmt to be a
@@ -997,17 +1059,18 @@ TYPE_PARSER(construct<AcImpliedDoControl>(
 
 // R801 type-declaration-stmt ->
 //        declaration-type-spec [[, attr-spec]... ::] entity-decl-list
-TYPE_PARSER(
+TYPE_PARSER(memoized("type-declaration-stmt"_en_US,
     construct<TypeDeclarationStmt>(declarationTypeSpec,
         optionalListBeforeColons(Parser<AttrSpec>{}),
         nonemptyList("expected entity declarations"_err_en_US, entityDecl)) ||
-    // PGI-only extension: don't require the colons
-    // N.B.: The standard requires the colons if the entity
-    // declarations contain initializers.
-    extension<LanguageFeature::MissingColons>(construct<TypeDeclarationStmt>(
-        declarationTypeSpec, defaulted("," >> nonemptyList(Parser<AttrSpec>{})),
-        withMessage("expected entity declarations"_err_en_US,
-            "," >> nonemptyList(entityDecl)))))
+        // PGI-only extension: don't require the colons
+        // N.B.: The standard requires the colons if the entity
+        // declarations contain initializers.
+        extension<LanguageFeature::MissingColons>(
+            construct<TypeDeclarationStmt>(declarationTypeSpec,
+                defaulted("," >> nonemptyList(Parser<AttrSpec>{})),
+                withMessage("expected entity declarations"_err_en_US,
+                    "," >> nonemptyList(entityDecl))))))
 
 // R802 attr-spec ->
 //        access-spec | ALLOCATABLE | ASYNCHRONOUS |
@@ -1882,8 +1945,12 @@ constexpr struct Level5Expr {
 
 // R1022 expr -> [expr defined-binary-op] level-5-expr
 // Defined binary operators associate leftwards.
+// An expression fails to parse exactly when its first level-5-expr does,
+// and alternative productions often attempt an expression more than once
+// at the same position, so those failures are memoized.
 template<> inline std::optional<Expr> Parser<Expr>::Parse(ParseState &state) {
-  std::optional<Expr> result{level5Expr.Parse(state)};
+  static constexpr auto firstOperand{memoized("expr"_en_US, level5Expr)};
+  std::optional<Expr> result{firstOperand.Parse(state)};
   if (result) {
     auto source{result->source};
     std::function<Expr(DefinedOpName &&, Expr &&)> defBinOp{
@@ -0,0 +1,91 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "memoized-parser.h"
+#include "message.h"
+#include "parse-state.h"
+#include <utility>
+
+namespace Fortran::parser {
+
+ParsingMemo::Start::Start(const ParseState &state)
+  : context{state.context()},
+    contextMessage{context == nullptr ? nullptr : context->message()},
+    deferMessages{state.deferMessages()},
+    anyDeferredMessages{state.anyDeferredMessages()},
+    anyTokenMatched{state.anyTokenMatched()},
+    anyConformanceViolation{state.anyConformanceViolation()},
+    anyErrorRecovery{state.anyErrorRecovery()} {}
+
+bool ParsingMemo::Start::operator==(const Start &that) const {
+  return context == that.context && contextMessage == that.contextMessage &&
+      deferMessages == that.deferMessages &&
+      anyDeferredMessages == that.anyDeferredMessages &&
+      anyTokenMatched == that.anyTokenMatched &&
+      anyConformanceViolation == that.anyConformanceViolation &&
+      anyErrorRecovery == that.anyErrorRecovery;
+}
+
+void ParsingMemo::clear() {
+  table_.clear();
+  hits_ = 0;
+}
+
+bool ParsingMemo::Fails(const MessageFixedText &tag, ParseState &state) {
+  const char *at{state.GetLocation()};
+  auto iter{table_.find(Key{at, tag.text().begin()})};
+  if (iter == table_.end()) {
+    return false;
+  }
+  const Entry &entry{iter->second};
+  Start start{state};
+  if (entry.messages.empty()) {
+    // Only messages refer to the context in which they were emitted.
+    start.context = entry.start.context;
+    start.contextMessage = entry.start.contextMessage;
+  }
+  if (!(start == entry.start)) {
+    return false;
+  }
+  ++hits_;
+  state.UncheckedAdvance(entry.end - at);
+  state.set_anyDeferredMessages(entry.anyDeferredMessages);
+  state.set_anyTokenMatched(entry.anyTokenMatched);
+  if (entry.anyConformanceViolation) {
+    state.set_anyConformanceViolation();
+  }
+  if (entry.anyErrorRecovery) {
+    state.set_anyErrorRecovery();
+  }
+  state.messages().Copy(entry.messages);
+  return true;
+}
+
+void ParsingMemo::NoteFailure(const MessageFixedText &tag,
+    const ParseState &before, const ParseState &after) {
+  const char *at{before.GetLocation()};
+  if (after.GetLocation() >= at) {
+    Message *contextMessage{nullptr};
+    if (!after.messages().empty()) {
+      contextMessage = before.ContextMessage();
+    }
+    Entry entry{Start{before}, Message::Reference{contextMessage},
+        after.GetLocation(), after.anyDeferredMessages(),
+        after.anyTokenMatched(), after.anyConformanceViolation(),
+        after.anyErrorRecovery()};
+    entry.messages.Copy(after.messages());
+    table_.insert_or_assign(Key{at, tag.text().begin()}, std::move(entry));
+  }
+}
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FORTRAN_PARSER_MEMOIZED_PARSER_H_
+#define FORTRAN_PARSER_MEMOIZED_PARSER_H_
+
+// If p is a parser, memoized("..."_en_US, p) is a parser that records
+// each failure of p in a table that lasts for the duration of one parse,
+// keyed by the tag and the position in the cooked character stream.
+// A later attempt at the same production and position then fails
+// immediately, replaying the final position, flags, and messages of the
+// original failure, as in packrat parsing.  Parse trees are move-only, so
+// successful parses are not recorded and will be repeated.
+
+#include "message.h"
+#include "parse-state.h"
+#include "user-state.h"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace Fortran::parser {
+
+class ParsingMemo {
+public:
+  ParsingMemo() {}
+
+  void clear();
+  std::size_t size() const { return table_.size(); }
+  std::size_t hits() const { return hits_; }
+
+  bool Fails(const MessageFixedText &tag, ParseState &);
+  void NoteFailure(const MessageFixedText &tag, const ParseState &before,
+      const ParseState &after);
+
+private:
+  // The state at the start of a parse, apart from its messages, on which
+  // the outcome of a failed parse depends.  Parsing contexts live on the
+  // stack, so their addresses are reused; a context is identified by its
+  // address together with the Message, if any, that was made for it.
+  struct Start {
+    explicit Start(const ParseState &);
+    bool operator==(const Start &) const;
+    const ParseContext *context;
+    const Message *contextMessage;
+    bool deferMessages, anyDeferredMessages, anyTokenMatched,
+        anyConformanceViolation, anyErrorRecovery;
+  };
+  struct Entry {
+    Start start;
+    Message::Reference contextMessage;  // keeps start.contextMessage unique
+    const char *end;
+    bool anyDeferredMessages, anyTokenMatched, anyConformanceViolation,
+        anyErrorRecovery;
+    Messages messages;
+  };
+  using Key = std::pair<const char *, const char *>;  // position, tag
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const {
+      return std::hash<const char *>{}(key.first) * 31 +
+          std::hash<const char *>{}(key.second);
+    }
+  };
+  std::unordered_map<Key, Entry, KeyHash> table_;
+  std::size_t hits_{0};
+};
+
+template<typename PA> class MemoizedParser {
+public:
+  using resultType = typename PA::resultType;
+  constexpr MemoizedParser(const MemoizedParser &) = default;
+  constexpr MemoizedParser(const MessageFixedText &tag, const PA &parser)
+    : tag_{tag}, parser_{parser} {}
+  std::optional<resultType> Parse(ParseState &state) const {
+    if (UserState * ustate{state.userState()}) {
+      if (ParsingMemo * memo{ustate->memo()}) {
+        if (memo->Fails(tag_, state)) {
+          return std::nullopt;
+        }
+        Messages messages{std::move(state.messages())};
+        ParseState before{state};
+        std::optional<resultType> result{parser_.Parse(state)};
+        if (!result.has_value()) {
+          memo->NoteFailure(tag_, before, state);
+        }
+        state.messages().Restore(std::move(messages));
+        return result;
+      }
+    }
+    return parser_.Parse(state);
+  }
+
+private:
+  const MessageFixedText tag_;
+  const PA parser_;
+};
+
+template<typename PA>
+inline constexpr auto memoized(const MessageFixedText &tag, const PA &parser) {
+  return MemoizedParser{tag, parser};
+}
+}
+#endif  // FORTRAN_PARSER_MEMOIZED_PARSER_H_
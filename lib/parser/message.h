@@ -237,6 +237,16 @@ public:
   }
 
   bool empty() const { return messages_.empty(); }
+  // The most recent message, if any; a change shows that messages were added
+  const Message *last() const {
+    return messages_.empty() ? nullptr : &*last_;
+  }
+  std::forward_list<Message>::const_iterator begin() const {
+    return messages_.begin();
+  }
+  std::forward_list<Message>::const_iterator end() const {
+    return messages_.end();
+  }
   void clear();
 
   template<typename... A> Message &Say(A &&... args) {
@@ -36,11 +36,46 @@
 
 namespace Fortran::parser {
 
+// A nested message context for parsing.  These are allocated on the stack
+// by the parsers that push them, since they are popped in LIFO order, and
+// converted into reference-counted Messages only when some message has to
+// be attached to them.
+class ParseContext {
+public:
+  explicit ParseContext(const MessageFixedText &text) : text_{text} {}
+  ParseContext(const ParseContext &) = delete;
+  ParseContext &operator=(const ParseContext &) = delete;
+
+  const ParseContext *outer() const { return outer_; }
+  Message *message() const { return message_.get(); }  // if any yet
+
+  Message *AsMessage() const {
+    if (!message_) {
+      Message *m{new Message{at_, text_}};  // reference-counted
+      if (outer_ != nullptr) {
+        m->SetContext(outer_->AsMessage());
+      }
+      message_ = Message::Reference{m};
+    }
+    return message_.get();
+  }
+
+private:
+  friend class ParseState;
+  const char *at_{nullptr};
+  const MessageFixedText text_;
+  const ParseContext *outer_{nullptr};
+  mutable Message::Reference message_;
+};
+
 class ParseState {
 public:
   // TODO: Add a constructor for parsing a normalized module file.
   ParseState(const CookedSource &cooked)
     : p_{&cooked.data().front()}, limit_{&cooked.data().back() + 1} {}
+  // Parses only a range of the cooked character stream.
+  explicit ParseState(const CharBlock &range)
+    : p_{range.begin()}, limit_{range.end()} {}
   ParseState(const ParseState &that)
     : p_{that.p_}, limit_{that.limit_}, context_{that.context_},
       userState_{that.userState_}, inFixedForm_{that.inFixedForm_},
@@ -51,7 +86,7 @@ public:
       anyTokenMatched_{that.anyTokenMatched_} {}
   ParseState(ParseState &&that)
     : p_{that.p_}, limit_{that.limit_}, messages_{std::move(that.messages_)},
-      context_{std::move(that.context_)}, userState_{that.userState_},
+      context_{that.context_}, userState_{that.userState_},
       inFixedForm_{that.inFixedForm_},
       anyErrorRecovery_{that.anyErrorRecovery_},
       anyConformanceViolation_{that.anyConformanceViolation_},
@@ -70,7 +105,7 @@ public:
   }
   ParseState &operator=(ParseState &&that) {
     p_ = that.p_, limit_ = that.limit_, messages_ = std::move(that.messages_);
-    context_ = std::move(that.context_);
+    context_ = that.context_;
     userState_ = that.userState_, inFixedForm_ = that.inFixedForm_;
     anyErrorRecovery_ = that.anyErrorRecovery_;
     anyConformanceViolation_ = that.anyConformanceViolation_;
@@ -83,8 +118,10 @@ public:
   const Messages &messages() const { return messages_; }
   Messages &messages() { return messages_; }
 
-  const Message::Reference &context() const { return context_; }
-  Message::Reference &context() { return context_; }
+  const ParseContext *context() const { return context_; }
+  Message *ContextMessage() const {
+    return context_ == nullptr ? nullptr : context_->AsMessage();
+  }
 
   bool anyErrorRecovery() const { return anyErrorRecovery_; }
   void set_anyErrorRecovery() { anyErrorRecovery_ = true; }
@@ -124,22 +161,24 @@ public:
 
   const char *GetLocation() const { return p_; }
 
-  void PushContext(MessageFixedText text) {
-    auto m{new Message{p_, text}};  // reference-counted
-    m->SetContext(context_.get());
-    context_ = Message::Reference{m};
+  // The context must remain in place until it is popped.
+  void PushContext(ParseContext &context) {
+    context.at_ = p_;
+    context.outer_ = context_;
+    context_ = &context;
   }
 
   void PopContext() {
-    CHECK(context_);
-    context_ = context_->attachment();
+    CHECK(context_ != nullptr);
+    context_ = context_->outer_;
   }
 
   template<typename... A> void Say(CharBlock range, A &&... args) {
     if (deferMessages_) {
       anyDeferredMessages_ = true;
     } else {
-      messages_.Say(range, std::forward<A>(args)...).SetContext(context_.get());
+      messages_.Say(range, std::forward<A>(args)...)
+          .SetContext(ContextMessage());
     }
   }
   template<typename... A> void Say(const MessageFixedText &text, A &&... args) {
@@ -197,14 +236,49 @@ public:
     return remain;
   }
 
-  void CombineFailedParses(ParseState &&prev) {
+  // A Checkpoint records everything that parsing can change in a
+  // ParseState apart from its messages, which the backtracking parsers
+  // set aside themselves.  Taking one and rolling back to it are much
+  // cheaper than copying and assigning whole ParseState instances.
+  class Checkpoint {
+  private:
+    friend class ParseState;
+    const char *p_;
+    const ParseContext *context_;
+    bool anyErrorRecovery_, anyConformanceViolation_, deferMessages_,
+        anyDeferredMessages_, anyTokenMatched_;
+  };
+
+  Checkpoint MakeCheckpoint() const {
+    Checkpoint result;
+    result.p_ = p_, result.context_ = context_;
+    result.anyErrorRecovery_ = anyErrorRecovery_;
+    result.anyConformanceViolation_ = anyConformanceViolation_;
+    result.deferMessages_ = deferMessages_;
+    result.anyDeferredMessages_ = anyDeferredMessages_;
+    result.anyTokenMatched_ = anyTokenMatched_;
+    return result;
+  }
+
+  void Rollback(const Checkpoint &to) {
+    p_ = to.p_, context_ = to.context_;
+    anyErrorRecovery_ = to.anyErrorRecovery_;
+    anyConformanceViolation_ = to.anyConformanceViolation_;
+    deferMessages_ = to.deferMessages_;
+    anyDeferredMessages_ = to.anyDeferredMessages_;
+    anyTokenMatched_ = to.anyTokenMatched_;
+  }
+
+  // Combines this failed parse with a previous one that ended at "prev"
+  // with "prevMessages".
+  void CombineFailedParses(const Checkpoint &prev, Messages &&prevMessages) {
     if (prev.anyTokenMatched_) {
       if (!anyTokenMatched_ || prev.p_ > p_) {
         anyTokenMatched_ = true;
         p_ = prev.p_;
-        messages_ = std::move(prev.messages_);
+        messages_ = std::move(prevMessages);
       } else if (prev.p_ == p_) {
-        messages_.Merge(std::move(prev.messages_));
+        messages_.Merge(std::move(prevMessages));
       }
     }
     anyDeferredMessages_ |= prev.anyDeferredMessages_;
@@ -218,7 +292,7 @@ private:
 
   // Accumulated messages and current nested context.
   Messages messages_;
-  Message::Reference context_;
+  const ParseContext *context_{nullptr};
 
   UserState *userState_{nullptr};
 
@@ -230,7 +304,7 @@ private:
   bool anyTokenMatched_{false};
   // NOTE: Any additions or modifications to these data members must also be
   // reflected in the copy and move constructors defined at the top of this
-  // class definition!
+  // class definition, and in Checkpoint if parsing can change them!
 };
 }
 #endif  // FORTRAN_PARSER_PARSE_STATE_H_
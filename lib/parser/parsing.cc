@@ -15,13 +15,23 @@
 #include "parsing.h"
 #include "grammar.h"
 #include "instrumented-parser.h"
+#include "memoized-parser.h"
 #include "message.h"
 #include "openmp-grammar.h"
 #include "preprocessor.h"
 #include "prescan.h"
 #include "provenance.h"
 #include "source.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <list>
 #include <sstream>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 namespace Fortran::parser {
 
@@ -96,10 +106,16 @@ void Parsing::DumpParsingLog(std::ostream &out) const {
 }
 
 void Parsing::Parse(std::ostream *out) {
+  if (options_.parseThreads > 1 && !options_.instrumentedParse &&
+      ParseInParallel(out)) {
+    return;
+  }
   UserState userState{cooked_, options_.features};
+  ParsingMemo memo;
   userState.set_debugOutput(out)
       .set_instrumentedParse(options_.instrumentedParse)
-      .set_log(&log_);
+      .set_log(&log_)
+      .set_memo(&memo);
   ParseState parseState{cooked_};
   parseState.set_inFixedForm(options_.isFixedForm).set_userState(&userState);
   parseTree_ = program.Parse(parseState);
@@ -110,6 +126,349 @@ void Parsing::Parse(std::ostream *out) {
   finalRestingPlace_ = parseState.GetLocation();
 }
 
+// Parallel parsing: the cooked character stream is split into ranges at
+// the lines of END statements that appear to end program units, and the
+// program units in each range are parsed concurrently.  The lexical scan
+// that finds those lines can be fooled, so a range is accepted only when
+// its parse reaches its end with the END statement of a program unit,
+// whether or not it recovered from errors along the way.  Otherwise, it is
+// parsed again together with the range that follows it and, should that
+// fail too, together with all of the rest of the cooked character stream.
+
+enum class LineKind {
+  Blank,  // or a comment or compiler directive
+  FixedFormDirective,
+  FreeFormDirective,
+  Contains,
+  Interface,
+  EndInterface,
+  Type,  // begins a derived type definition
+  EndType,
+  End,  // could end a program unit or a subprogram
+  Other
+};
+
+// Matches a keyword in a line of cooked characters, skipping spaces, which
+// fixed form does not have.
+static bool MatchKeyword(const char *&p, const char *end, const char *word) {
+  const char *q{p};
+  for (; *word != '\0'; ++word, ++q) {
+    while (q < end && *q == ' ') {
+      ++q;
+    }
+    if (q == end || *q != *word) {
+      return false;
+    }
+  }
+  p = q;
+  return true;
+}
+
+static bool IsRestOfStatementEmpty(const char *p, const char *end) {
+  for (; p < end; ++p) {
+    if (*p != ' ' && *p != ';') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool IsRestOfStatementAName(const char *p, const char *end) {
+  for (; p < end && *p != ';'; ++p) {
+    if (*p != ' ' && !IsLegalInIdentifier(*p)) {
+      return false;
+    }
+  }
+  return IsRestOfStatementEmpty(p, end);
+}
+
+// '=' outside parentheses: an assignment, a statement function, or
+// (in fixed form) a DO statement, but not a statement of interest.
+static bool HasEqualsOutsideParentheses(const char *p, const char *end) {
+  int depth{0};
+  for (; p < end; ++p) {
+    if (*p == '(') {
+      ++depth;
+    } else if (*p == ')') {
+      --depth;
+    } else if (*p == '=' && depth == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the rest of a line that begins with TYPE is a derived type
+// statement, as opposed to a TYPE(...) declaration, a TYPE IS guard, or
+// the legacy TYPE statement for output.
+static bool IsTypeDefinition(const char *p, const char *end) {
+  while (p < end && *p == ' ') {
+    ++p;
+  }
+  if (p == end || HasEqualsOutsideParentheses(p, end)) {
+    return false;
+  }
+  if (*p == ',' || *p == ':') {
+    return true;
+  }
+  if (!IsLegalIdentifierStart(*p)) {
+    return false;
+  }
+  const char *q{p};
+  return !MatchKeyword(q, end, "is") || !MatchKeyword(q, end, "(");
+}
+
+// Classifies a line of cooked characters from its start to its newline.
+static LineKind ClassifyLine(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || IsDecimalDigit(*p))) {
+    ++p;  // skip a label
+  }
+  if (p == end) {
+    return LineKind::Blank;
+  }
+  if (*p == '!') {
+    std::string line{p, static_cast<std::size_t>(end - p)};
+    if (line == "!dir$ fixed") {
+      return LineKind::FixedFormDirective;
+    } else if (line == "!dir$ free") {
+      return LineKind::FreeFormDirective;
+    } else {
+      return LineKind::Blank;
+    }
+  }
+  const char *start{p};
+  if (MatchKeyword(p, end, "end")) {
+    if (IsRestOfStatementEmpty(p, end)) {
+      return LineKind::End;
+    }
+    if (MatchKeyword(p, end, "interface")) {
+      return LineKind::EndInterface;
+    }
+    if (const char *q{p};
+        MatchKeyword(q, end, "type") && IsRestOfStatementAName(q, end)) {
+      return LineKind::EndType;
+    }
+    for (const char *unit : {"program", "module", "submodule", "subroutine",
+             "function", "procedure", "blockdata"}) {
+      const char *q{p};
+      if (MatchKeyword(q, end, unit) && IsRestOfStatementAName(q, end)) {
+        return LineKind::End;
+      }
+    }
+    return LineKind::Other;
+  }
+  p = start;
+  if (MatchKeyword(p, end, "contains") && IsRestOfStatementEmpty(p, end)) {
+    return LineKind::Contains;
+  }
+  p = start;
+  if (MatchKeyword(p, end, "type") && IsTypeDefinition(p, end)) {
+    return LineKind::Type;
+  }
+  p = start;
+  MatchKeyword(p, end, "abstract");
+  if (MatchKeyword(p, end, "interface") &&
+      !HasEqualsOutsideParentheses(p, end)) {
+    return LineKind::Interface;
+  }
+  return LineKind::Other;
+}
+
+// A range of the cooked character stream to be parsed as a sequence of
+// program units, and the source form in effect at its beginning
+struct UnitRange {
+  CharBlock chars;
+  bool inFixedForm;
+};
+
+// Splits the cooked character stream into at most about the given number
+// of ranges of similar sizes.  Internal and module subprograms end with
+// the same END statements as program units do, but their hosts have
+// CONTAINS statements, and a host's END statement immediately follows
+// the END statement of its last subprogram (or its CONTAINS statement).
+// Interface bodies are skipped, as are the CONTAINS statements of derived
+// type definitions.
+static std::vector<UnitRange> SplitAtProgramUnits(
+    const CookedSource &cooked, bool inFixedForm, std::size_t ranges) {
+  const char *p{cooked.data().data()};
+  const char *limit{p + cooked.data().size()};
+  const char *tail{limit};
+  while (tail > p && (tail[-1] == ' ' || tail[-1] == '\n')) {
+    --tail;
+  }
+  std::size_t bytes{static_cast<std::size_t>(limit - p)};
+  std::size_t target{std::max<std::size_t>(bytes / ranges, 1)};
+  std::vector<UnitRange> result;
+  const char *begin{p};
+  bool beginInFixedForm{inFixedForm};
+  int interfaces{0}, types{0}, hosts{0};
+  LineKind previous{LineKind::Other};
+  while (p < limit) {
+    const char *newline{
+        static_cast<const char *>(std::memchr(p, '\n', limit - p))};
+    const char *end{newline != nullptr ? newline : limit};
+    LineKind kind{ClassifyLine(p, end)};
+    p = newline != nullptr ? newline + 1 : limit;
+    switch (kind) {
+    case LineKind::Blank: continue;
+    case LineKind::FixedFormDirective: inFixedForm = true; continue;
+    case LineKind::FreeFormDirective: inFixedForm = false; continue;
+    case LineKind::Contains:
+      if (interfaces == 0 && types == 0) {
+        ++hosts;
+      }
+      break;
+    case LineKind::Interface: ++interfaces; break;
+    case LineKind::EndInterface:
+      if (interfaces > 0) {
+        --interfaces;
+      }
+      break;
+    case LineKind::Type: ++types; break;
+    case LineKind::EndType:
+      if (types > 0) {
+        --types;
+      }
+      break;
+    case LineKind::End:
+      if (interfaces == 0 && types == 0) {
+        if (hosts > 0) {
+          if (previous != LineKind::End && previous != LineKind::Contains) {
+            break;  // ends an internal or module subprogram
+          }
+          --hosts;
+        }
+        if (hosts == 0 && p < tail &&
+            static_cast<std::size_t>(p - begin) >= target) {
+          result.push_back(UnitRange{CharBlock{begin, p}, beginInFixedForm});
+          begin = p;
+          beginInFixedForm = inFixedForm;
+        }
+      }
+      break;
+    case LineKind::Other: break;
+    }
+    previous = kind;
+  }
+  result.push_back(UnitRange{CharBlock{begin, limit}, beginInFixedForm});
+  return result;
+}
+
+// The program units parsed from a range, with the parse's messages and
+// final position
+struct ParsedUnits {
+  std::optional<std::list<ProgramUnit>> units;
+  Messages messages;
+  const char *at{nullptr};
+  bool anyErrorRecovery{false};
+};
+
+static ParsedUnits ParseUnits(const CookedSource &cooked,
+    const Options &options, std::ostream *out, const UnitRange &range,
+    bool isFirst) {
+  UserState userState{cooked, options.features};
+  ParsingLog log;
+  ParsingMemo memo;
+  userState.set_debugOutput(out).set_log(&log).set_memo(&memo);
+  ParseState parseState{range.chars};
+  parseState.set_inFixedForm(range.inFixedForm).set_userState(&userState);
+  ParsedUnits result;
+  if (isFirst) {
+    static constexpr auto units{
+        some(programUnitLines) / skipStuffBeforeStatement};
+    result.units = units.Parse(parseState);
+  } else {
+    // Continue as program's some() does after the first program unit.
+    static constexpr auto moreUnits{
+        many(programUnitLines) / skipStuffBeforeStatement};
+    parseState.set_anyTokenMatched();
+    result.units = moreUnits.Parse(parseState);
+  }
+  result.messages = std::move(parseState.messages());
+  result.at = parseState.GetLocation();
+  result.anyErrorRecovery = parseState.anyErrorRecovery();
+  return result;
+}
+
+// Whether the parse of a range reached its end with an actual END statement
+// of a program unit, rather than stopping short of it or running into it
+// in the middle of a program unit, for which error recovery supplies an
+// empty END statement
+static bool EndsWithEndStatement(
+    const ParsedUnits &result, const UnitRange &range) {
+  if (!result.units.has_value() || result.units->empty() ||
+      result.at != range.chars.end()) {
+    return false;
+  }
+  CharBlock source{std::visit(
+      [](const auto &x) {
+        const auto &t{x.value().t};
+        using Tuple = std::decay_t<decltype(t)>;
+        return std::get<std::tuple_size_v<Tuple> - 1>(t).source;
+      },
+      result.units->back().u)};
+  return !source.empty();
+}
+
+bool Parsing::ParseInParallel(std::ostream *out) {
+  std::size_t threads{static_cast<std::size_t>(options_.parseThreads)};
+  std::vector<UnitRange> ranges{
+      SplitAtProgramUnits(cooked_, options_.isFixedForm, 4 * threads)};
+  parsedRanges_ = ranges.size();
+  if (ranges.size() < 2) {
+    return false;
+  }
+  std::vector<ParsedUnits> parsed(ranges.size());
+  std::atomic<std::size_t> next{0};
+  auto worker{[&]() {
+    for (std::size_t j{next++}; j < ranges.size(); j = next++) {
+      parsed[j] = ParseUnits(cooked_, options_, out, ranges[j], j == 0);
+    }
+  }};
+  std::vector<std::thread> workers;
+  for (std::size_t j{1}; j < std::min(threads, ranges.size()); ++j) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : workers) {
+    thread.join();
+  }
+  // Splice the program units together in order.
+  std::list<ProgramUnit> units;
+  for (std::size_t j{0}; j < ranges.size();) {
+    ParsedUnits result{std::move(parsed[j])};
+    std::size_t last{j};
+    auto reparse{[&](std::size_t through) {
+      last = through;
+      UnitRange merged{
+          CharBlock{ranges[j].chars.begin(), ranges[last].chars.end()},
+          ranges[j].inFixedForm};
+      result = ParseUnits(cooked_, options_, out, merged, j == 0);
+    }};
+    // Try again with the next range, and then with all of the rest.
+    for (std::size_t through : {j + 1, ranges.size() - 1}) {
+      if (last + 1 < ranges.size() &&
+          !EndsWithEndStatement(result, ranges[last])) {
+        reparse(through);
+      }
+    }
+    CHECK(!result.anyErrorRecovery || result.messages.AnyFatalError());
+    messages_.Annex(std::move(result.messages));
+    if (result.units.has_value()) {
+      units.splice(units.end(), *result.units);
+    }
+    finalRestingPlace_ = result.at;
+    j = last + 1;
+  }
+  consumedWholeFile_ = finalRestingPlace_ == ranges.back().chars.end();
+  if (units.empty()) {
+    parseTree_.reset();  // the first range did not parse
+  } else {
+    parseTree_ = Program{std::move(units)};
+  }
+  return true;
+}
+
 void Parsing::ClearLog() { log_.clear(); }
 
 bool Parsing::ForTesting(std::string path, std::ostream &err) {
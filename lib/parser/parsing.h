@@ -41,6 +41,7 @@ struct Options {
   std::vector<Predefinition> predefinitions;
   bool instrumentedParse{false};
   bool isModuleFile{false};
+  int parseThreads{1};  // > 1: parse program units concurrently
 };
 
 class Parsing {
@@ -50,6 +51,8 @@ public:
 
   bool consumedWholeFile() const { return consumedWholeFile_; }
   const char *finalRestingPlace() const { return finalRestingPlace_; }
+  // The number of ranges of program units split off for parallel parsing
+  std::size_t parsedRanges() const { return parsedRanges_; }
   CookedSource &cooked() { return cooked_; }
   Messages &messages() { return messages_; }
   std::optional<Program> &parseTree() { return parseTree_; }
@@ -70,11 +73,14 @@ public:
   bool ForTesting(std::string path, std::ostream &);
 
 private:
+  bool ParseInParallel(std::ostream *debugOutput);
+
   Options options_;
   CookedSource cooked_;
   Messages messages_;
   bool consumedWholeFile_{false};
   const char *finalRestingPlace_{nullptr};
+  std::size_t parsedRanges_{1};
   std::optional<Program> parseTree_;
   ParsingLog log_;
 };
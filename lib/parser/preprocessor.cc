@@ -113,6 +113,7 @@ static TokenSequence Stringify(
 TokenSequence Definition::Apply(
     const std::vector<TokenSequence> &args, AllSources &allSources) {
   TokenSequence result;
+  result.reserve(replacement_);
   bool pasting{false};
   bool skipping{false};
   int parenthesesNesting{0};
@@ -238,10 +239,13 @@ std::optional<TokenSequence> Preprocessor::MacroReplacement(
   if (j == tokens) {
     return std::nullopt;  // input contains nothing that would be replaced
   }
-  TokenSequence result{input, 0, j};
+  TokenSequence result;
+  result.reserve(input);
+  result.Put(input, 0, j);
   for (; j < tokens; ++j) {
     const CharBlock &token{input.TokenAt(j)};
-    if (token.IsBlank() || !IsLegalIdentifierStart(token[0])) {
+    if (token.IsBlank() || !IsLegalIdentifierStart(token[0]) ||
+        !MightBeDefined(token)) {
       result.Put(input, j);
       continue;
     }
@@ -276,8 +280,11 @@ std::optional<TokenSequence> Preprocessor::MacroReplacement(
         }
       }
       def.set_isDisabled(true);
-      TokenSequence replaced{ReplaceMacros(def.replacement(), prescanner)};
+      std::optional<TokenSequence> rescanned{
+          MacroReplacement(def.replacement(), prescanner)};
       def.set_isDisabled(false);
+      const TokenSequence &replaced{
+          rescanned.has_value() ? *rescanned : def.replacement()};
       if (!replaced.empty()) {
         ProvenanceRange from{def.replacement().GetProvenanceRange()};
         ProvenanceRange use{input.GetTokenProvenanceRange(j)};
@@ -330,6 +337,7 @@ std::optional<TokenSequence> Preprocessor::MacroReplacement(
       continue;
     }
     std::vector<TokenSequence> args;
+    args.reserve(argStart.size());
     for (std::size_t n{0}; n < argStart.size(); ++n) {
       std::size_t at{argStart[n]};
       std::size_t count{
@@ -337,9 +345,11 @@ std::optional<TokenSequence> Preprocessor::MacroReplacement(
       args.emplace_back(TokenSequence(input, at, count));
     }
     def.set_isDisabled(true);
-    TokenSequence replaced{
-        ReplaceMacros(def.Apply(args, allSources_), prescanner)};
+    TokenSequence applied{def.Apply(args, allSources_)};
+    std::optional<TokenSequence> rescanned{
+        MacroReplacement(applied, prescanner)};
     def.set_isDisabled(false);
+    const TokenSequence &replaced{rescanned.has_value() ? *rescanned : applied};
     if (!replaced.empty()) {
       ProvenanceRange from{def.replacement().GetProvenanceRange()};
       ProvenanceRange use{input.GetIntervalProvenanceRange(j, k - j)};
@@ -581,16 +591,9 @@ void Preprocessor::Directive(const TokenSequence &dir, Prescanner *prescanner) {
       return;
     }
     std::stringstream error;
-    const SourceFile *included{allSources_.Open(include, &error)};
-    if (included == nullptr) {
+    if (!prescanner->Include(include, dir.GetProvenanceRange(), &error)) {
       prescanner->Say(dir.GetTokenProvenanceRange(dirOffset),
           "#include: %s"_err_en_US, error.str());
-    } else if (included->bytes() > 0) {
-      ProvenanceRange fileRange{
-          allSources_.AddIncludedFile(*included, dir.GetProvenanceRange())};
-      Prescanner{*prescanner}
-          .set_encoding(included->encoding())
-          .Prescan(fileRange);
     }
   } else {
     prescanner->Say(dir.GetTokenProvenanceRange(dirOffset),
@@ -598,13 +601,39 @@ void Preprocessor::Directive(const TokenSequence &dir, Prescanner *prescanner) {
   }
 }
 
+std::size_t Preprocessor::NameFilterIndex(const CharBlock &name) {
+  std::size_t first{static_cast<unsigned char>(name[0]) & 0x7fu};
+  return first * nameFilterLengths + (name.size() - 1) % nameFilterLengths;
+}
+
+// Every macro name is saved here before it is defined.
 CharBlock Preprocessor::SaveTokenAsName(const CharBlock &t) {
   names_.push_back(t.ToString());
-  return {names_.back().data(), names_.back().size()};
+  CharBlock name{names_.back().data(), names_.back().size()};
+  if (!name.empty()) {
+    nameFilter_.set(NameFilterIndex(name));
+  }
+  return name;
+}
+
+bool Preprocessor::MightBeDefined(const CharBlock &token) const {
+  return !token.empty() && nameFilter_.test(NameFilterIndex(token));
 }
 
 bool Preprocessor::IsNameDefined(const CharBlock &token) {
-  return definitions_.find(token) != definitions_.end();
+  return MightBeDefined(token) &&
+      definitions_.find(token) != definitions_.end();
+}
+
+bool Preprocessor::IsAnyNameDefined(
+    const std::unordered_set<std::string> &names) const {
+  for (const auto &pair : definitions_) {
+    if (names.find(ToLowerCaseLetters(pair.first.ToString())) !=
+        names.end()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 static std::string GetDirectiveName(
@@ -628,11 +657,7 @@ void Preprocessor::SkipDisabledConditionalCode(const std::string &dirName,
     IsElseActive isElseActive, Prescanner *prescanner,
     ProvenanceRange provenanceRange) {
   int nesting{0};
-  while (!prescanner->IsAtEnd()) {
-    if (!prescanner->IsNextLinePreprocessorDirective()) {
-      prescanner->NextLine();
-      continue;
-    }
+  while (prescanner->SkipToNextPreprocessorDirectiveLine()) {
     TokenSequence line{prescanner->TokenizePreprocessorDirective()};
     std::size_t rest{0};
     std::string dn{GetDirectiveName(line, &rest)};
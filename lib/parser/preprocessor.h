@@ -24,11 +24,13 @@
 #include "char-block.h"
 #include "provenance.h"
 #include "token-sequence.h"
+#include <bitset>
 #include <cstddef>
 #include <list>
 #include <stack>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace Fortran::parser {
@@ -73,6 +75,9 @@ public:
 
   void Define(std::string macro, std::string value);
   void Undefine(std::string macro);
+  // Whether any of some lower-case names is currently defined as a macro,
+  // ignoring case
+  bool IsAnyNameDefined(const std::unordered_set<std::string> &) const;
 
   std::optional<TokenSequence> MacroReplacement(
       const TokenSequence &, const Prescanner &);
@@ -85,6 +90,8 @@ private:
   enum class CanDeadElseAppear { No, Yes };
 
   CharBlock SaveTokenAsName(const CharBlock &);
+  static std::size_t NameFilterIndex(const CharBlock &);
+  bool MightBeDefined(const CharBlock &) const;
   bool IsNameDefined(const CharBlock &);
   TokenSequence ReplaceMacros(const TokenSequence &, const Prescanner &);
   void SkipDisabledConditionalCode(
@@ -96,6 +103,13 @@ private:
   std::list<std::string> names_;
   std::unordered_map<CharBlock, Definition> definitions_;
   std::stack<CanDeadElseAppear> ifStack_;
+
+  // To avoid hashing and probing definitions_ for every name in every
+  // statement, names are checked first against a cheap filter indexed by
+  // their first characters and lengths.  It is set for every name that has
+  // ever been defined; #undef does not clear it.
+  static constexpr std::size_t nameFilterLengths{64};
+  std::bitset<128 * nameFilterLengths> nameFilter_;  // 1 KiB
 };
 }
 #endif  // FORTRAN_PARSER_PREPROCESSOR_H_
@@ -19,9 +19,12 @@
 #include "source.h"
 #include "token-sequence.h"
 #include "../common/idioms.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <sstream>
+#include <sys/stat.h>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -88,12 +91,13 @@ void Prescanner::Prescan(ProvenanceRange range) {
     }
     dir += '\n';
     TokenSequence tokens{dir, allSources.AddCompilerInsertion(dir).start()};
-    tokens.Emit(cooked_);
+    Emit(tokens);
   }
 }
 
 void Prescanner::Statement() {
-  TokenSequence tokens;
+  TokenSequence &tokens{statementTokens_};
+  tokens.clear();
   LineClassification line{ClassifyLine(nextLine_)};
   switch (line.kind) {
   case LineClassification::Kind::Comment:
@@ -108,6 +112,7 @@ void Prescanner::Statement() {
   case LineClassification::Kind::IncludeDirective:
   case LineClassification::Kind::DefinitionDirective:
   case LineClassification::Kind::PreprocessorDirective:
+    recording_ = nullptr;
     preprocessor_.Directive(TokenizePreprocessorDirective(), this);
     return;
   case LineClassification::Kind::CompilerDirective:
@@ -169,6 +174,7 @@ void Prescanner::Statement() {
   Provenance newlineProvenance{GetCurrentProvenance()};
   if (std::optional<TokenSequence> preprocessed{
           preprocessor_.MacroReplacement(tokens, *this)}) {
+    recording_ = nullptr;
     // Reprocess the preprocessed line.  Append a newline temporarily.
     preprocessed->PutNextTokenChar('\n', newlineProvenance);
     preprocessed->CloseToken();
@@ -186,7 +192,7 @@ void Prescanner::Statement() {
     case LineClassification::Kind::PreprocessorDirective:
       Say(preprocessed->GetProvenanceRange(),
           "Preprocessed line resembles a preprocessor directive"_en_US);
-      preprocessed->ToLowerCase().Emit(cooked_);
+      Emit(preprocessed->ToLowerCase());
       break;
     case LineClassification::Kind::CompilerDirective:
       if (preprocessed->HasRedundantBlanks()) {
@@ -195,7 +201,7 @@ void Prescanner::Statement() {
       NormalizeCompilerDirectiveCommentMarker(*preprocessed);
       preprocessed->ToLowerCase();
       SourceFormChange(preprocessed->ToString());
-      preprocessed->ClipComment(true /* skip first ! */).Emit(cooked_);
+      Emit(preprocessed->ClipComment(true /* skip first ! */));
       break;
     case LineClassification::Kind::Source:
       if (inFixedForm_) {
@@ -207,7 +213,7 @@ void Prescanner::Statement() {
           preprocessed->RemoveRedundantBlanks();
         }
       }
-      preprocessed->ToLowerCase().ClipComment().Emit(cooked_);
+      Emit(preprocessed->ToLowerCase().ClipComment());
       break;
     }
   } else {
@@ -215,12 +221,12 @@ void Prescanner::Statement() {
     if (line.kind == LineClassification::Kind::CompilerDirective) {
       SourceFormChange(tokens.ToString());
     }
-    tokens.Emit(cooked_);
+    Emit(tokens);
   }
   if (omitNewline_) {
     omitNewline_ = false;
   } else {
-    cooked_.Put('\n', newlineProvenance);
+    EmitNewline(newlineProvenance);
   }
   directiveSentinel_ = nullptr;
 }
@@ -486,6 +492,7 @@ bool Prescanner::NextToken(TokenSequence &tokens) {
     }
     preventHollerith_ = false;
   } else if (IsLegalInIdentifier(*at_)) {
+    EmitNameCharsInBulk(tokens);
     do {
     } while (IsLegalInIdentifier(EmitCharAndAdvance(tokens, *at_)));
     if (*at_ == '\'' || *at_ == '"') {
@@ -530,6 +537,27 @@ bool Prescanner::NextToken(TokenSequence &tokens) {
   return true;
 }
 
+// Emits all but the last of the characters of a name that appear together
+// on the current line (and, in fixed form, before the right margin) in one
+// piece.  Advancing over them one at a time with NextChar() would never
+// encounter a continuation, comment, or margin, so this is just faster;
+// the last character of the run is left for NextChar() to handle.
+void Prescanner::EmitNameCharsInBulk(TokenSequence &tokens) {
+  const char *last{at_};
+  while (IsLegalInIdentifier(last[1])) {
+    ++last;
+  }
+  if (inFixedForm_ && !inPreprocessorDirective_ && !tabInCurrentLine_) {
+    last = std::min(last, at_ + std::max(fixedFormColumnLimit_ - column_, 0));
+  }
+  if (last > at_) {
+    std::size_t bytes{static_cast<std::size_t>(last - at_)};
+    tokens.PutNextTokenChars(at_, bytes, GetCurrentProvenance());
+    at_ = last;
+    column_ += bytes;
+  }
+}
+
 bool Prescanner::ExponentAndKind(TokenSequence &tokens) {
   char ed{ToLowerCaseLetter(*at_)};
   if (ed != 'e' && ed != 'd') {
@@ -749,19 +777,101 @@ void Prescanner::FortranInclude(const char *firstQuote) {
   if (currentFile != nullptr) {
     allSources.PushSearchPathDirectory(DirectoryName(currentFile->path()));
   }
-  const SourceFile *included{allSources.Open(path, &error)};
+  ProvenanceRange includeLineRange{
+      provenance, static_cast<std::size_t>(p - nextLine_)};
+  bool ok{Include(path, includeLineRange, &error)};
   if (currentFile != nullptr) {
     allSources.PopSearchPathDirectory();
   }
-  if (included == nullptr) {
+  if (!ok) {
     Say(provenance, "INCLUDE: %s"_err_en_US, error.str());
-  } else if (included->bytes() > 0) {
-    ProvenanceRange includeLineRange{
-        provenance, static_cast<std::size_t>(p - nextLine_)};
+  }
+}
+
+// The names that a macro definition could replace in the tokens recorded
+// while prescanning a source file, in lower case.  These are the names as
+// MacroReplacement sees them, after continued lines have been joined and
+// blanks in fixed form names have been removed.
+static std::unordered_set<std::string> IdentifierNames(
+    const TokenSequence &recording) {
+  std::unordered_set<std::string> names;
+  for (std::size_t j{0}; j < recording.SizeInTokens(); ++j) {
+    CharBlock token{recording.TokenAt(j)};
+    if (!token.empty() && IsLegalIdentifierStart(token[0])) {
+      names.emplace(ToLowerCaseLetters(token.ToString()));
+    }
+  }
+  return names;
+}
+
+// Identifies a file and the prescanning state that could affect the
+// cooked characters that it yields.
+std::optional<std::string> Prescanner::IncludeKey(
+    const std::string &path) const {
+  struct stat statbuf;
+  if (stat(path.c_str(), &statbuf) != 0 || !S_ISREG(statbuf.st_mode)) {
+    return std::nullopt;
+  }
+  std::stringstream key;
+  key << statbuf.st_dev << ':' << statbuf.st_ino << ':' << statbuf.st_size
+      << ':' << statbuf.st_mtime;
+#ifdef __linux__
+  key << '.' << statbuf.st_mtim.tv_nsec;
+#endif
+  key << ':' << inFixedForm_ << skipLeadingAmpersand_ << ':'
+      << fixedFormColumnLimit_ << ':' << static_cast<int>(encoding_) << ':';
+  for (std::size_t j{0}; j < LanguageFeature_enumSize; ++j) {
+    key << features_.IsEnabled(static_cast<LanguageFeature>(j));
+  }
+  std::vector<std::string> sentinels{compilerDirectiveSentinels_.begin(),
+      compilerDirectiveSentinels_.end()};
+  std::sort(sentinels.begin(), sentinels.end());
+  for (const std::string &sentinel : sentinels) {
+    key << ':' << sentinel;
+  }
+  return key.str();
+}
+
+bool Prescanner::Include(const std::string &path, ProvenanceRange includeLine,
+    std::stringstream *error) {
+  recording_ = nullptr;  // an includer isn't reused apart from its inclusions
+  AllSources &allSources{cooked_.allSources()};
+  std::optional<std::string> key{IncludeKey(allSources.Locate(path))};
+  if (key.has_value()) {
+    const auto *prior{allSources.FindPrescannedInclude(*key)};
+    if (prior != nullptr && !preprocessor_.IsAnyNameDefined(prior->names)) {
+      ProvenanceRange fileRange{
+          allSources.AddIncludedFile(prior->source, includeLine)};
+      cooked_.Put(prior->cooked);
+      cooked_.PutProvenanceMappings(
+          prior->provenances, prior->range, fileRange.start());
+      return true;
+    }
+  }
+  const SourceFile *included{allSources.Open(path, error)};
+  if (included == nullptr) {
+    return false;
+  }
+  if (included->bytes() > 0) {
     ProvenanceRange fileRange{
-        allSources.AddIncludedFile(*included, includeLineRange)};
-    Prescanner{*this}.set_encoding(included->encoding()).Prescan(fileRange);
+        allSources.AddIncludedFile(*included, includeLine)};
+    Prescanner prescanner{*this};
+    prescanner.set_encoding(included->encoding());
+    TokenSequence recording;
+    if (key.has_value()) {
+      prescanner.recording_ = &recording;
+    }
+    const Message *lastMessage{messages_.last()};
+    prescanner.Prescan(fileRange);
+    if (prescanner.recording_ != nullptr && messages_.last() == lastMessage &&
+        recording.provenances().IsRelocatable(fileRange)) {
+      allSources.AddPrescannedInclude(std::move(*key),
+          AllSources::PrescannedInclude{*included, fileRange,
+              recording.ToString(), recording.provenances(),
+              IdentifierNames(recording)});
+    }
   }
+  return true;
 }
 
 const char *Prescanner::IsPreprocessorDirectiveLine(const char *start) const {
@@ -785,6 +895,27 @@ bool Prescanner::IsNextLinePreprocessorDirective() const {
   return IsPreprocessorDirectiveLine(nextLine_) != nullptr;
 }
 
+bool Prescanner::SkipToNextPreprocessorDirectiveLine() {
+  // Rather than classifying each line, search the raw bytes for '#'
+  // characters and check only the lines that contain them.
+  const char *p{nextLine_};
+  while (nextLine_ < limit_ && !IsNextLinePreprocessorDirective()) {
+    const void *v{std::memchr(p, '#', limit_ - p)};
+    if (v == nullptr) {
+      nextLine_ = limit_;
+      break;
+    }
+    const char *hash{static_cast<const char *>(v)};
+    const char *line{hash};
+    while (line > nextLine_ && line[-1] != '\n') {
+      --line;
+    }
+    nextLine_ = line;
+    p = hash + 1;
+  }
+  return nextLine_ < limit_;
+}
+
 bool Prescanner::SkipCommentLine(bool afterAmpersand) {
   if (nextLine_ >= limit_) {
     if (afterAmpersand && prescannerNesting_ > 0) {
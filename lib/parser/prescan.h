@@ -29,6 +29,7 @@
 #include "token-sequence.h"
 #include <bitset>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <unordered_set>
 
@@ -64,9 +65,20 @@ public:
   void Statement();
   void NextLine();
 
+  // Implements INCLUDE and #include.  A file that has already been
+  // prescanned without any preprocessing or diagnostics is not read and
+  // prescanned again when nothing has changed that could affect the result;
+  // its cooked characters are reused.  Returns false if the file can't
+  // be read.
+  bool Include(const std::string &path, ProvenanceRange includeLine,
+      std::stringstream *error);
+
   // Callbacks for use by Preprocessor.
   bool IsAtEnd() const { return nextLine_ >= limit_; }
   bool IsNextLinePreprocessorDirective() const;
+  // Skips disabled conditional code up to the next preprocessor directive
+  // line; returns false at the end of the source.
+  bool SkipToNextPreprocessorDirectiveLine();
   TokenSequence TokenizePreprocessorDirective();
   Provenance GetCurrentProvenance() const { return GetProvenance(at_); }
 
@@ -121,6 +133,21 @@ private:
     return {startProvenance_ + (first - start_), bytes};
   }
 
+  void Emit(const TokenSequence &tokens) {
+    tokens.Emit(cooked_);
+    if (recording_ != nullptr) {
+      recording_->Put(tokens);
+    }
+  }
+
+  void EmitNewline(Provenance provenance) {
+    cooked_.Put('\n', provenance);
+    if (recording_ != nullptr) {
+      recording_->PutNextTokenChar('\n', provenance);
+      recording_->CloseToken();
+    }
+  }
+
   void EmitChar(TokenSequence &tokens, char ch) {
     tokens.PutNextTokenChar(ch, GetCurrentProvenance());
   }
@@ -136,6 +163,8 @@ private:
     return *at_;
   }
 
+  void EmitNameCharsInBulk(TokenSequence &);
+
   bool InCompilerDirective() const { return directiveSentinel_ != nullptr; }
   bool InFixedFormSource() const {
     return inFixedForm_ && !inPreprocessorDirective_ && !InCompilerDirective();
@@ -167,6 +196,7 @@ private:
   const char *IsFreeFormComment(const char *) const;
   std::optional<std::size_t> IsIncludeLine(const char *) const;
   void FortranInclude(const char *quote);
+  std::optional<std::string> IncludeKey(const std::string &path) const;
   const char *IsPreprocessorDirectiveLine(const char *) const;
   const char *FixedFormContinuationLine(bool mightNeedSpace);
   const char *FreeFormContinuationLine(bool ampersand);
@@ -220,6 +250,16 @@ private:
   bool omitNewline_{false};
   bool skipLeadingAmpersand_{false};
 
+  // While an included file is being prescanned, its cooked characters are
+  // also recorded here so that later inclusions can reuse them.  Anything
+  // that makes the result depend on more than the file's own content
+  // (macro replacement, directives, nested inclusion) stops the recording.
+  TokenSequence *recording_{nullptr};
+
+  // The tokens of the current statement; cleared, but not deallocated,
+  // between statements so that its buffers are reused.
+  TokenSequence statementTokens_;
+
   const Provenance spaceProvenance_{
       cooked_.allSources().CompilerInsertionProvenance(' ')};
   const Provenance backslashProvenance_{
@@ -18,12 +18,26 @@
 
 namespace Fortran::parser {
 
+// The hints that speed up Map() and MapToOrigin() are kept per thread,
+// since those const lookups may be made concurrently, and remember the
+// table that they index.
+struct LookupHint {
+  const void *table{nullptr};
+  std::size_t index{0};
+};
+static thread_local LookupHint lastHit, lastOrigin;
+
 void OffsetToProvenanceMappings::clear() { provenanceMap_.clear(); }
 
 void OffsetToProvenanceMappings::swap(OffsetToProvenanceMappings &that) {
   provenanceMap_.swap(that.provenanceMap_);
 }
 
+void OffsetToProvenanceMappings::reserve(
+    const OffsetToProvenanceMappings &that) {
+  provenanceMap_.reserve(that.provenanceMap_.size());
+}
+
 void OffsetToProvenanceMappings::shrink_to_fit() {
   provenanceMap_.shrink_to_fit();
 }
@@ -36,6 +50,10 @@ std::size_t OffsetToProvenanceMappings::size() const {
   return last.start + last.range.size();
 }
 
+std::size_t OffsetToProvenanceMappings::HeapBytes() const {
+  return provenanceMap_.capacity() * sizeof(ContiguousProvenanceMapping);
+}
+
 void OffsetToProvenanceMappings::Put(ProvenanceRange range) {
   if (provenanceMap_.empty()) {
     provenanceMap_.push_back({0, range});
@@ -53,9 +71,42 @@ void OffsetToProvenanceMappings::Put(const OffsetToProvenanceMappings &that) {
   }
 }
 
+void OffsetToProvenanceMappings::PutRelocated(
+    const OffsetToProvenanceMappings &that, ProvenanceRange from,
+    Provenance to) {
+  for (const auto &map : that.provenanceMap_) {
+    if (from.Contains(map.range)) {
+      Put({to + from.MemberOffset(map.range.start()), map.range.size()});
+    } else {
+      CHECK(from.IsDisjointWith(map.range));
+      Put(map.range);
+    }
+  }
+}
+
+bool OffsetToProvenanceMappings::IsRelocatable(ProvenanceRange range) const {
+  for (const auto &map : provenanceMap_) {
+    if (!range.Contains(map.range) && !range.IsDisjointWith(map.range)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 ProvenanceRange OffsetToProvenanceMappings::Map(std::size_t at) const {
   //  CHECK(!provenanceMap_.empty());
-  std::size_t low{0}, count{provenanceMap_.size()};
+  // Queries tend to follow one another through the cooked source, so try
+  // the mapping that satisfied the last one, and its successor, first.
+  std::size_t entries{provenanceMap_.size()};
+  std::size_t hint{lastHit.table == this ? lastHit.index : entries};
+  for (std::size_t j{hint}; j < entries && j <= hint + 1; ++j) {
+    if (provenanceMap_[j].start <= at &&
+        (j + 1 == entries || at < provenanceMap_[j + 1].start)) {
+      lastHit.index = j;
+      return provenanceMap_[j].range.Suffix(at - provenanceMap_[j].start);
+    }
+  }
+  std::size_t low{0}, count{entries};
   while (count > 1) {
     std::size_t mid{low + (count >> 1)};
     if (provenanceMap_[mid].start > at) {
@@ -65,6 +116,7 @@ ProvenanceRange OffsetToProvenanceMappings::Map(std::size_t at) const {
       low = mid;
     }
   }
+  lastHit = LookupHint{this, low};
   std::size_t offset{at - provenanceMap_[low].start};
   return provenanceMap_[low].range.Suffix(offset);
 }
@@ -91,6 +143,29 @@ AllSources::AllSources() : range_{1, 1} {
 
 AllSources::~AllSources() {}
 
+std::size_t AllSources::HeapBytes() const {
+  std::size_t bytes{origin_.capacity() * sizeof(Origin)};
+  for (const Origin &origin : origin_) {
+    std::visit(
+        common::visitors{
+            [&](const Macro &macro) {
+              bytes += macro.uses.capacity() * sizeof(ProvenanceRange);
+            },
+            [&](const CompilerInsertion &ins) { bytes += ins.text.capacity(); },
+            [](const auto &) {},
+        },
+        origin.u);
+  }
+  for (const std::string &expansion : macroExpansions_) {
+    bytes += sizeof expansion + expansion.capacity();
+  }
+  for (const auto &pair : prescannedIncludes_) {
+    bytes += pair.second.cooked.capacity() +
+        pair.second.provenances.HeapBytes();
+  }
+  return bytes;
+}
+
 const char &AllSources::operator[](Provenance at) const {
   const Origin &origin{MapToOrigin(at)};
   return origin[origin.covers.MemberOffset(at)];
@@ -115,6 +190,21 @@ const SourceFile *AllSources::Open(std::string path, std::stringstream *error) {
   return nullptr;
 }
 
+std::string AllSources::Locate(const std::string &path) const {
+  return LocateSourceFile(path, searchPath_);
+}
+
+const AllSources::PrescannedInclude *AllSources::FindPrescannedInclude(
+    const std::string &key) const {
+  auto iter{prescannedIncludes_.find(key)};
+  return iter == prescannedIncludes_.end() ? nullptr : &iter->second;
+}
+
+void AllSources::AddPrescannedInclude(
+    std::string key, PrescannedInclude &&include) {
+  prescannedIncludes_.emplace(std::move(key), std::move(include));
+}
+
 const SourceFile *AllSources::ReadStandardInput(std::stringstream *error) {
   std::unique_ptr<SourceFile> source{std::make_unique<SourceFile>(encoding_)};
   if (source->ReadStandardInput(error)) {
@@ -136,8 +226,19 @@ ProvenanceRange AllSources::AddMacroCall(
     ProvenanceRange def, ProvenanceRange use, const std::string &expansion) {
   ProvenanceRange covers{range_.NextAfter(), expansion.size()};
   CHECK(range_.AnnexIfPredecessor(covers));
-  CHECK(origin_.back().covers.ImmediatelyPrecedes(covers));
-  origin_.emplace_back(covers, def, use, expansion);
+  Origin &last{origin_.back()};
+  CHECK(last.covers.ImmediatelyPrecedes(covers));
+  if (auto *macro{std::get_if<Macro>(&last.u)}) {
+    if (!expansion.empty() && macro->definition == def &&
+        macro->expansion == expansion) {
+      // Extend the run of calls with the same expansion.
+      last.covers.Annex(covers);
+      macro->uses.push_back(use);
+      return covers;
+    }
+  }
+  const std::string &interned{*macroExpansions_.insert(expansion).first};
+  origin_.emplace_back(covers, def, use, interned);
   return covers;
 }
 
@@ -200,13 +301,15 @@ void AllSources::EmitMessage(std::ostream &o,
             }
           },
           [&](const Macro &mac) {
-            EmitMessage(o, origin.replaces, message, echoSourceLine);
+            std::size_t offset{origin.covers.MemberOffset(range->start())};
+            std::size_t call{mac.CallAt(offset)};
+            EmitMessage(o, mac.uses[call], message, echoSourceLine);
             EmitMessage(
                 o, mac.definition, "in a macro defined here", echoSourceLine);
             if (echoSourceLine) {
               o << "that expanded to:\n  " << mac.expansion << "\n  ";
-              for (std::size_t j{0};
-                   origin.covers.OffsetMember(j) < range->start(); ++j) {
+              std::size_t column{offset - call * mac.expansion.size()};
+              for (std::size_t j{0}; j < column; ++j) {
                 o << (mac.expansion[j] == '\t' ? '\t' : ' ');
               }
               o << "^\n";
@@ -229,7 +332,8 @@ const SourceFile *AllSources::GetSourceFile(
             return &inc.source;
           },
           [&](const Macro &mac) {
-            return GetSourceFile(origin.replaces.start(), offset);
+            std::size_t call{mac.CallAt(origin.covers.MemberOffset(at))};
+            return GetSourceFile(mac.uses[call].start(), offset);
           },
           [offset](const CompilerInsertion &) {
             if (offset != nullptr) {
@@ -246,6 +350,13 @@ ProvenanceRange AllSources::GetContiguousRangeAround(
   CHECK(IsValid(range));
   const Origin &origin{MapToOrigin(range.start())};
   CHECK(origin.covers.Contains(range));
+  if (const auto *macro{std::get_if<Macro>(&origin.u)}) {
+    std::size_t size{macro->expansion.size()};
+    std::size_t call{macro->CallAt(origin.covers.MemberOffset(range.start()))};
+    ProvenanceRange callRange{origin.covers.OffsetMember(call * size), size};
+    CHECK(callRange.Contains(range));
+    return callRange;
+  }
   return origin.covers;
 }
 
@@ -278,7 +389,7 @@ AllSources::Origin::Origin(ProvenanceRange r, const SourceFile &included,
   : u{Inclusion{included, isModule}}, covers{r}, replaces{from} {}
 AllSources::Origin::Origin(ProvenanceRange r, ProvenanceRange def,
     ProvenanceRange use, const std::string &expansion)
-  : u{Macro{def, expansion}}, covers{r}, replaces{use} {}
+  : u{Macro{def, expansion, {use}}}, covers{r} {}
 AllSources::Origin::Origin(ProvenanceRange r, const std::string &text)
   : u{CompilerInsertion{text}}, covers{r} {}
 
@@ -288,7 +399,9 @@ const char &AllSources::Origin::operator[](std::size_t n) const {
           [n](const Inclusion &inc) -> const char & {
             return inc.source.content()[n];
           },
-          [n](const Macro &mac) -> const char & { return mac.expansion[n]; },
+          [n](const Macro &mac) -> const char & {
+            return mac.expansion[n % mac.expansion.size()];
+          },
           [n](const CompilerInsertion &ins) -> const char & {
             return ins.text[n];
           },
@@ -298,6 +411,10 @@ const char &AllSources::Origin::operator[](std::size_t n) const {
 
 const AllSources::Origin &AllSources::MapToOrigin(Provenance at) const {
   CHECK(range_.Contains(at));
+  if (lastOrigin.table == this && lastOrigin.index < origin_.size() &&
+      origin_[lastOrigin.index].covers.Contains(at)) {
+    return origin_[lastOrigin.index];
+  }
   std::size_t low{0}, count{origin_.size()};
   while (count > 1) {
     std::size_t mid{low + (count >> 1)};
@@ -309,6 +426,7 @@ const AllSources::Origin &AllSources::MapToOrigin(Provenance at) const {
     }
   }
   CHECK(origin_[low].covers.Contains(at));
+  lastOrigin = LookupHint{this, low};
   return origin_[low];
 }
 
@@ -367,7 +485,15 @@ std::ostream &AllSources::Dump(std::ostream &o) const {
               }
               o << "file " << inc.source.path();
             },
-            [&](const Macro &mac) { o << "macro " << mac.expansion; },
+            [&](const Macro &mac) {
+              o << "macro " << mac.expansion;
+              if (mac.uses.size() == 1) {
+                o << " replaces ";
+                DumpRange(o, mac.uses[0]);
+              } else {
+                o << " (" << mac.uses.size() << " calls)";
+              }
+            },
             [&](const CompilerInsertion &ins) {
               o << "compiler '" << ins.text << '\'';
               if (ins.text.length() == 1) {
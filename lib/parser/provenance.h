@@ -28,6 +28,7 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -91,11 +92,18 @@ class OffsetToProvenanceMappings {
 public:
   OffsetToProvenanceMappings() {}
   std::size_t size() const;
+  std::size_t HeapBytes() const;  // memory occupied by the mappings
   void clear();
   void swap(OffsetToProvenanceMappings &);
   void shrink_to_fit();
+  void reserve(const OffsetToProvenanceMappings &);  // room for as many
   void Put(ProvenanceRange);
   void Put(const OffsetToProvenanceMappings &);
+  // Appends mappings with the provenances that lie within one range
+  // moved to the same offsets in another range that starts at "to".
+  void PutRelocated(
+      const OffsetToProvenanceMappings &, ProvenanceRange from, Provenance to);
+  bool IsRelocatable(ProvenanceRange) const;  // nothing straddles its bounds
   ProvenanceRange Map(std::size_t at) const;
   void RemoveLastBytes(std::size_t);
   std::ostream &Dump(std::ostream &) const;
@@ -117,6 +125,9 @@ public:
   ~AllSources();
 
   std::size_t size() const { return range_.size(); }
+  // Memory occupied by the origins and prescanned includes, apart from
+  // the source files themselves
+  std::size_t HeapBytes() const;
   const char &operator[](Provenance) const;
   Encoding encoding() const { return encoding_; }
   AllSources &set_encoding(Encoding e) {
@@ -135,6 +146,20 @@ public:
       ProvenanceRange def, ProvenanceRange use, const std::string &expansion);
   ProvenanceRange AddCompilerInsertion(std::string);
 
+  // The cooked characters and their provenances that resulted from the
+  // prescanning of an included file, kept so that later inclusions of the
+  // same unchanged file in the same circumstances can reuse them.
+  struct PrescannedInclude {
+    const SourceFile &source;
+    ProvenanceRange range;  // of the inclusion that was prescanned
+    std::string cooked;
+    OffsetToProvenanceMappings provenances;
+    std::unordered_set<std::string> names;  // lower case; see IsAnyNameDefined
+  };
+  std::string Locate(const std::string &path) const;  // via search path
+  const PrescannedInclude *FindPrescannedInclude(const std::string &key) const;
+  void AddPrescannedInclude(std::string key, PrescannedInclude &&);
+
   bool IsValid(Provenance at) const { return range_.Contains(at); }
   bool IsValid(ProvenanceRange range) const {
     return range.size() > 0 && range_.Contains(range);
@@ -158,9 +183,16 @@ private:
   struct Module {
     const SourceFile &source;
   };
+  // Consecutive calls to the same macro with the same expansion share
+  // one origin; each call covers the next expansion.size() provenances.
+  // Expansion texts are interned.
   struct Macro {
+    std::size_t CallAt(std::size_t offset) const {
+      return expansion.empty() ? 0 : offset / expansion.size();
+    }
     ProvenanceRange definition;
-    std::string expansion;
+    const std::string &expansion;
+    std::vector<ProvenanceRange> uses;  // one per call
   };
   struct CompilerInsertion {
     std::string text;
@@ -185,7 +217,9 @@ private:
   std::vector<Origin> origin_;
   ProvenanceRange range_;
   std::map<char, Provenance> compilerInsertionProvenance_;
+  std::unordered_set<std::string> macroExpansions_;
   std::vector<std::unique_ptr<SourceFile>> ownedSourceFiles_;
+  std::map<std::string, PrescannedInclude> prescannedIncludes_;
   std::vector<std::string> searchPath_;
   Encoding encoding_{Encoding::UTF_8};
 };
@@ -198,6 +232,9 @@ public:
   AllSources &allSources() { return allSources_; }
   const AllSources &allSources() const { return allSources_; }
   const std::string &data() const { return data_; }
+  const OffsetToProvenanceMappings &provenanceMap() const {
+    return provenanceMap_;
+  }
 
   bool IsValid(const char *p) const {
     return p >= &data_.front() && p <= &data_.back() + 1;
@@ -226,6 +263,10 @@ public:
   void PutProvenanceMappings(const OffsetToProvenanceMappings &pm) {
     provenanceMap_.Put(pm);
   }
+  void PutProvenanceMappings(const OffsetToProvenanceMappings &pm,
+      ProvenanceRange from, Provenance to) {
+    provenanceMap_.PutRelocated(pm, from, to);
+  }
 
   void Marshal();  // marshals text into one contiguous block
   std::string AcquireData() { return std::move(data_); }
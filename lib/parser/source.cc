@@ -13,11 +13,12 @@
 // limitations under the License.
 
 #include "source.h"
-#include "char-buffer.h"
 #include "../common/idioms.h"
 #include <algorithm>
 #include <cerrno>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
 #include <memory>
@@ -26,6 +27,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 // TODO: Port to Windows &c.
 
@@ -33,31 +37,148 @@ namespace Fortran::parser {
 
 static constexpr bool useMMap{true};
 static constexpr int minMapFileBytes{1};  // i.e., no minimum requirement
-static constexpr int maxMapOpenFileDescriptors{100};
-static int openFileDescriptors{0};
+static constexpr std::size_t initialReadBufferBytes{1 << 16};
+static constexpr std::size_t minReadBytes{1 << 12};
 
 SourceFile::~SourceFile() { Close(); }
 
-static std::vector<std::size_t> FindLineStarts(
-    const char *source, std::size_t bytes) {
-  std::vector<std::size_t> result;
-  if (bytes > 0) {
-    CHECK(source[bytes - 1] == '\n' && "missing ultimate newline");
-    std::size_t at{0};
-    do {
-      result.push_back(at);
-      const void *vp{static_cast<const void *>(&source[at])};
-      const void *vnl{std::memchr(vp, '\n', bytes - at)};
-      const char *nl{static_cast<const char *>(vnl)};
-      at = nl + 1 - source;
-    } while (at < bytes);
-    result.shrink_to_fit();
+// Sources are scanned for newlines and carriage returns a block of bytes
+// at a time; ScanBlock() returns bit masks of their positions in a block.
+struct BlockMasks {
+  std::uint32_t newlines, carriageReturns;
+};
+
+#if defined(__AVX2__)
+static constexpr std::size_t scanBlockBytes{32};
+static inline BlockMasks ScanBlock(const char *p) {
+  __m256i block{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))};
+  __m256i nl{_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'))};
+  __m256i cr{_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\r'))};
+  return {static_cast<std::uint32_t>(_mm256_movemask_epi8(nl)),
+      static_cast<std::uint32_t>(_mm256_movemask_epi8(cr))};
+}
+#elif defined(__SSE2__)
+static constexpr std::size_t scanBlockBytes{16};
+static inline BlockMasks ScanBlock(const char *p) {
+  __m128i block{_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))};
+  __m128i nl{_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))};
+  __m128i cr{_mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))};
+  return {static_cast<std::uint32_t>(_mm_movemask_epi8(nl)),
+      static_cast<std::uint32_t>(_mm_movemask_epi8(cr))};
+}
+#else
+// Portably, eight bytes at a time: set the high bit of each byte of a
+// word that matches a character, then gather those bits into a mask.
+static inline std::uint32_t MatchMask(std::uint64_t word, char ch) {
+  constexpr std::uint64_t ones{0x0101010101010101}, lows{0x7f7f7f7f7f7f7f7f};
+  std::uint64_t x{word ^ (ones * static_cast<unsigned char>(ch))};
+  std::uint64_t matches{~(((x & lows) + lows) | x | lows)};
+  return static_cast<std::uint32_t>(
+      ((matches >> 7) * 0x0102040810204080) >> 56);
+}
+
+static constexpr std::size_t scanBlockBytes{16};
+static inline BlockMasks ScanBlock(const char *p) {
+  BlockMasks masks{0, 0};
+  for (int j{0}; j < 2; ++j) {
+    std::uint64_t word;
+    std::memcpy(&word, p + 8 * j, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    masks.newlines |= MatchMask(word, '\n') << (8 * j);
+    masks.carriageReturns |= MatchMask(word, '\r') << (8 * j);
+  }
+  return masks;
+}
+#endif
+
+// Appends the start of the line that follows each newline in a mask.
+static inline void RecordNewlines(std::uint32_t newlines, std::size_t at,
+    std::vector<std::size_t> &lineStarts) {
+  for (; newlines != 0; newlines &= newlines - 1) {
+    lineStarts.push_back(at + __builtin_ctz(newlines) + 1);
+  }
+}
+
+bool FindLineStarts(const char *source, std::size_t bytes,
+    std::vector<std::size_t> &lineStarts) {
+  lineStarts.clear();
+  if (bytes == 0) {
+    return true;
+  }
+  lineStarts.push_back(0);
+  std::size_t at{0};
+  for (; at + scanBlockBytes <= bytes; at += scanBlockBytes) {
+    BlockMasks masks{ScanBlock(source + at)};
+    if (masks.carriageReturns != 0) {
+      return false;
+    }
+    RecordNewlines(masks.newlines, at, lineStarts);
+  }
+  for (; at < bytes; ++at) {
+    if (source[at] == '\r') {
+      return false;
+    } else if (source[at] == '\n') {
+      lineStarts.push_back(at + 1);
+    }
+  }
+  if (lineStarts.back() == bytes) {
+    lineStarts.pop_back();  // the ultimate newline doesn't start a line
+  }
+  lineStarts.shrink_to_fit();
+  return true;
+}
+
+// Deletes the carriage returns from the "bytes" characters that follow
+// offset "start" in a buffer, appending the offsets in the buffer of the
+// positions that follow their newlines; returns their new count.
+static std::size_t RemoveCarriageReturns(char *buffer, std::size_t start,
+    std::size_t bytes, std::vector<std::size_t> &lineStarts) {
+  std::size_t wrote{start}, at{start}, limit{start + bytes};
+  for (; at + scanBlockBytes <= limit; at += scanBlockBytes) {
+    BlockMasks masks{ScanBlock(buffer + at)};
+    if (masks.carriageReturns == 0) {
+      std::memmove(buffer + wrote, buffer + at, scanBlockBytes);
+      RecordNewlines(masks.newlines, wrote, lineStarts);
+      wrote += scanBlockBytes;
+    } else {
+      for (std::size_t j{at}; j < at + scanBlockBytes; ++j) {
+        char ch{buffer[j]};
+        if (ch != '\r') {
+          buffer[wrote++] = ch;
+          if (ch == '\n') {
+            lineStarts.push_back(wrote);
+          }
+        }
+      }
+    }
+  }
+  for (; at < limit; ++at) {
+    char ch{buffer[at]};
+    if (ch != '\r') {
+      buffer[wrote++] = ch;
+      if (ch == '\n') {
+        lineStarts.push_back(wrote);
+      }
+    }
   }
-  return result;
+  return wrote - start;
 }
 
-void SourceFile::RecordLineStarts() {
-  lineStart_ = FindLineStarts(content_, bytes_);
+std::size_t RemoveCarriageReturns(
+    char *buffer, std::size_t bytes, std::vector<std::size_t> &lineStarts) {
+  lineStarts.clear();
+  if (bytes == 0) {
+    return 0;
+  }
+  lineStarts.push_back(0);
+  std::size_t wrote{RemoveCarriageReturns(buffer, 0, bytes, lineStarts)};
+  if (lineStarts.back() == wrote) {
+    lineStarts.pop_back();
+  }
+  lineStarts.shrink_to_fit();
+  return wrote;
 }
 
 // Check for a Unicode byte order mark (BOM).
@@ -96,51 +217,33 @@ std::string LocateSourceFile(
   return name;
 }
 
-static std::size_t RemoveCarriageReturns(char *buffer, std::size_t bytes) {
-  std::size_t wrote{0};
-  char *p{buffer};
-  while (bytes > 0) {
-    void *vp{static_cast<void *>(p)};
-    void *crvp{std::memchr(vp, '\r', bytes)};
-    char *crcp{static_cast<char *>(crvp)};
-    if (crcp == nullptr) {
-      std::memmove(buffer + wrote, p, bytes);
-      wrote += bytes;
-      break;
-    }
-    std::size_t chunk = crcp - p;
-    std::memmove(buffer + wrote, p, chunk);
-    wrote += chunk;
-    p += chunk + 1;
-    bytes -= chunk + 1;
-  }
-  return wrote;
-}
-
 bool SourceFile::Open(std::string path, std::stringstream *error) {
   Close();
   path_ = path;
   std::string errorPath{"'"s + path + "'"};
   errno = 0;
-  fileDescriptor_ = open(path.c_str(), O_RDONLY);
-  if (fileDescriptor_ < 0) {
+  int fileDescriptor{open(path.c_str(), O_RDONLY)};
+  if (fileDescriptor < 0) {
     *error << "could not open " << errorPath << ": " << std::strerror(errno);
     return false;
   }
-  ++openFileDescriptors;
-  return ReadFile(errorPath, error);
+  // A mapping remains valid after its file descriptor has been closed,
+  // so no descriptor is held open once the file has been read.
+  bool ok{ReadFile(fileDescriptor, errorPath, error)};
+  close(fileDescriptor);
+  return ok;
 }
 
 bool SourceFile::ReadStandardInput(std::stringstream *error) {
   Close();
   path_ = "standard input";
-  fileDescriptor_ = 0;
-  return ReadFile(path_, error);
+  return ReadFile(0, path_, error);
 }
 
-bool SourceFile::ReadFile(std::string errorPath, std::stringstream *error) {
+bool SourceFile::ReadFile(
+    int fileDescriptor, std::string errorPath, std::stringstream *error) {
   struct stat statbuf;
-  if (fstat(fileDescriptor_, &statbuf) != 0) {
+  if (fstat(fileDescriptor, &statbuf) != 0) {
     *error << "fstat failed on " << errorPath << ": " << std::strerror(errno);
     Close();
     return false;
@@ -151,33 +254,29 @@ bool SourceFile::ReadFile(std::string errorPath, std::stringstream *error) {
     return false;
   }
 
-  // Try to map a large source file into the process' address space.
-  // Don't bother with small ones.  This also helps keep the number
-  // of open file descriptors from getting out of hand.
+  // Try to map a source file into the process' address space.
   if (useMMap && S_ISREG(statbuf.st_mode)) {
     size_ = static_cast<std::size_t>(statbuf.st_size);
-    if (size_ >= minMapFileBytes &&
-        openFileDescriptors <= maxMapOpenFileDescriptors) {
-      void *vp = mmap(0, size_, PROT_READ, MAP_SHARED, fileDescriptor_, 0);
+    if (size_ >= minMapFileBytes) {
+      void *vp = mmap(0, size_, PROT_READ, MAP_SHARED, fileDescriptor, 0);
       if (vp != MAP_FAILED) {
         address_ = static_cast<const char *>(const_cast<const void *>(vp));
         IdentifyPayload();
+        // One pass finds the line starts and any carriage returns.
         if (bytes_ > 0 && content_[bytes_ - 1] == '\n' &&
-            std::memchr(static_cast<const void *>(content_), '\r', bytes_) ==
-                nullptr) {
+            FindLineStarts(content_, bytes_, lineStart_)) {
           isMemoryMapped_ = true;
-          RecordLineStarts();
           return true;
         }
         // The file needs to have its line endings normalized to simple
         // newlines.  Remap it for a private rewrite in place.
         vp = mmap(
-            vp, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor_, 0);
+            vp, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
         if (vp != MAP_FAILED) {
           address_ = static_cast<const char *>(const_cast<const void *>(vp));
           IdentifyPayload();
           auto mutableContent{const_cast<char *>(content_)};
-          bytes_ = RemoveCarriageReturns(mutableContent, bytes_);
+          bytes_ = RemoveCarriageReturns(mutableContent, bytes_, lineStart_);
           if (bytes_ > 0) {
             if (mutableContent[bytes_ - 1] == '\n' ||
                 (bytes_ & 0xfff) != 0 /* don't cross into next page */) {
@@ -189,7 +288,6 @@ bool SourceFile::ReadFile(std::string errorPath, std::stringstream *error) {
               CHECK(isNowReadOnly);
               content_ = mutableContent;
               isMemoryMapped_ = true;
-              RecordLineStarts();
               return true;
             }
           }
@@ -201,38 +299,66 @@ bool SourceFile::ReadFile(std::string errorPath, std::stringstream *error) {
     }
   }
 
-  // Read it into an expandable buffer, then marshal its content into a single
-  // contiguous block.
-  CharBuffer buffer;
+  // Read it (e.g., from a pipe) into a single buffer, normalizing each chunk
+  // and finding its line starts as it arrives so that the work overlaps
+  // with whatever is writing the input.  The buffer grows by realloc(),
+  // which can extend large blocks without copying them.
+  char *buffer{nullptr};
+  std::size_t capacity{0}, bytes{0};
+  lineStart_.clear();
   while (true) {
-    std::size_t count;
-    char *to{buffer.FreeSpace(&count)};
-    ssize_t got{read(fileDescriptor_, to, count)};
+    if (capacity - bytes < minReadBytes) {
+      capacity = std::max(2 * capacity, initialReadBufferBytes);
+      // Leave room to append a final newline.
+      void *vp{std::realloc(buffer, capacity + 1)};
+      if (vp == nullptr) {
+        *error << "could not allocate memory to read " << errorPath;
+        std::free(buffer);
+        Close();
+        return false;
+      }
+      buffer = static_cast<char *>(vp);
+    }
+    ssize_t got{read(fileDescriptor, buffer + bytes, capacity - bytes)};
     if (got < 0) {
       *error << "could not read " << errorPath << ": " << std::strerror(errno);
+      std::free(buffer);
       Close();
       return false;
     }
     if (got == 0) {
       break;
     }
-    buffer.Claim(got);
-  }
-  if (fileDescriptor_ > 0) {
-    close(fileDescriptor_);
-    --openFileDescriptors;
+    if (bytes == 0) {
+      lineStart_.push_back(0);
+    }
+    bytes += RemoveCarriageReturns(buffer, bytes, got, lineStart_);
   }
-  fileDescriptor_ = -1;
-  if (buffer.size() == 0) {
-    // empty file
+  if (bytes == 0) {
+    // empty file, or nothing but carriage returns
+    std::free(buffer);
+    lineStart_.clear();
     address_ = content_ = nullptr;
     size_ = bytes_ = 0;
-  } else {
-    normalized_ = buffer.MarshalNormalized();
-    address_ = normalized_.data();
-    size_ = normalized_.size();
-    IdentifyPayload();
-    RecordLineStarts();
+    return true;
+  }
+  if (lineStart_.back() == bytes) {
+    lineStart_.pop_back();  // the ultimate newline doesn't start a line
+  } else if (buffer[bytes - 1] != '\n') {
+    buffer[bytes++] = '\n';  // append a final newline
+  }
+  if (void *vp{std::realloc(buffer, bytes)}) {
+    buffer = static_cast<char *>(vp);  // release the unused capacity
+  }
+  lineStart_.shrink_to_fit();
+  address_ = buffer;
+  size_ = bytes;
+  IdentifyPayload();
+  if (std::size_t bomBytes{size_ - bytes_}) {
+    // Line starts are relative to the content that follows the mark.
+    for (std::size_t j{1}; j < lineStart_.size(); ++j) {
+      lineStart_[j] -= bomBytes;
+    }
   }
   return true;
 }
@@ -241,18 +367,11 @@ void SourceFile::Close() {
   if (useMMap && isMemoryMapped_) {
     munmap(reinterpret_cast<void *>(const_cast<char *>(address_)), size_);
     isMemoryMapped_ = false;
-  } else if (!normalized_.empty()) {
-    normalized_.clear();
   } else if (address_ != nullptr) {
-    delete[] address_;
+    std::free(const_cast<char *>(address_));
   }
   address_ = content_ = nullptr;
   size_ = bytes_ = 0;
-  if (fileDescriptor_ > 0) {
-    close(fileDescriptor_);
-    --openFileDescriptors;
-  }
-  fileDescriptor_ = -1;
   path_.clear();
 }
 
@@ -33,6 +33,16 @@ std::string DirectoryName(std::string path);
 std::string LocateSourceFile(
     std::string name, const std::vector<std::string> &searchPath);
 
+// Finds the offsets of the starts of the lines of a source in one
+// vectorized pass.  Returns false, leaving lineStarts incomplete, if
+// the source contains a carriage return.
+bool FindLineStarts(
+    const char *, std::size_t bytes, std::vector<std::size_t> &lineStarts);
+// Deletes carriage returns in place and finds the line starts of the
+// result in the same pass; returns the new length.
+std::size_t RemoveCarriageReturns(
+    char *, std::size_t bytes, std::vector<std::size_t> &lineStarts);
+
 class SourceFile {
 public:
   explicit SourceFile(Encoding e) : encoding_{e} {}
@@ -52,19 +62,17 @@ public:
   }
 
 private:
-  bool ReadFile(std::string errorPath, std::stringstream *error);
+  bool ReadFile(
+      int fileDescriptor, std::string errorPath, std::stringstream *error);
   void IdentifyPayload();
-  void RecordLineStarts();
 
   std::string path_;
-  int fileDescriptor_{-1};
   bool isMemoryMapped_{false};
   const char *address_{nullptr};  // raw content
   std::size_t size_{0};
   const char *content_{nullptr};  // usable content
   std::size_t bytes_{0};
   std::vector<std::size_t> lineStart_;
-  std::string normalized_;
   Encoding encoding_{Encoding::UTF_8};
 };
 }
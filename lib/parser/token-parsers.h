@@ -27,12 +27,15 @@
 #include "../common/idioms.h"
 #include <cctype>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <functional>
 #include <limits>
 #include <list>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
 
 namespace Fortran::parser {
 
@@ -44,6 +47,7 @@ public:
   using resultType = const char *;
   constexpr AnyOfChars(const AnyOfChars &) = default;
   constexpr AnyOfChars(SetOfChars set) : set_{set} {}
+  constexpr SetOfChars set() const { return set_; }
   std::optional<const char *> Parse(ParseState &state) const {
     if (std::optional<const char *> at{state.PeekAtNextChar()}) {
       if (set_.Has(**at)) {
@@ -67,6 +71,110 @@ constexpr AnyOfChars operator""_ch(const char str[], std::size_t n) {
 constexpr auto letter{"abcdefghijklmnopqrstuvwxyz"_ch};
 constexpr auto digit{"0123456789"_ch};
 
+// If p is a parser that cannot succeed unless the next nonblank character
+// is one of x, y, or z, startingWith("xyz"_ch, p) is the same parser,
+// annotated with those characters for dispatch() below.
+template<typename PA> class StartingWithParser {
+public:
+  using resultType = typename PA::resultType;
+  constexpr StartingWithParser(const StartingWithParser &) = default;
+  constexpr StartingWithParser(SetOfChars set, const PA &parser)
+    : set_{set}, parser_{parser} {}
+  constexpr bool MightStartWith(SetOfChars ch) const { return set_.Has(ch); }
+  std::optional<resultType> Parse(ParseState &state) const {
+    return parser_.Parse(state);
+  }
+
+private:
+  const SetOfChars set_;
+  const PA parser_;
+};
+
+template<typename PA>
+inline constexpr auto startingWith(const AnyOfChars &chars, const PA &parser) {
+  return StartingWithParser<PA>{chars.set(), parser};
+}
+
+template<typename PA>
+constexpr bool MightStartWith(const PA &, SetOfChars) {
+  return true;
+}
+template<typename PA>
+constexpr bool MightStartWith(const StartingWithParser<PA> &p, SetOfChars ch) {
+  return p.MightStartWith(ch);
+}
+
+// dispatch(p1, p2, ...) is first(p1, p2, ...), but it looks at the next
+// nonblank character once and does not attempt any alternative of the form
+// startingWith(c, p) that cannot start with it.  Such an alternative would
+// only fail at its first token, so the outcome is that of first() apart
+// from the messages that it would have added there.  The last alternative
+// is always attempted so that a failure still has a position and messages.
+template<typename PA, typename... Ps> class DispatchParser {
+public:
+  using resultType = typename PA::resultType;
+  constexpr DispatchParser(PA pa, Ps... ps) : ps_{pa, ps...} {}
+  constexpr DispatchParser(const DispatchParser &) = default;
+  std::optional<resultType> Parse(ParseState &state) const {
+    SetOfChars next{NextNonblank(state)};
+    Messages messages{std::move(state.messages())};
+    ParseState::Checkpoint backtrack{state.MakeCheckpoint()};
+    std::optional<resultType> result;
+    bool attempted{false}, skipped{false};
+    ParseFrom<0>(result, state, backtrack, next, attempted, skipped);
+    if (!result.has_value() && skipped && state.deferMessages()) {
+      state.set_anyDeferredMessages();
+    }
+    state.messages().Restore(std::move(messages));
+    return result;
+  }
+
+private:
+  static SetOfChars NextNonblank(const ParseState &state) {
+    const char *p{state.GetLocation()};
+    for (std::size_t n{state.BytesRemaining()}; n > 0; --n, ++p) {
+      if (*p != ' ') {
+        return SetOfChars{*p};
+      }
+    }
+    return SetOfChars{};  // at the end, every alternative is a candidate
+  }
+
+  template<std::size_t J>
+  void ParseFrom(std::optional<resultType> &result, ParseState &state,
+      const ParseState::Checkpoint &backtrack, SetOfChars next,
+      bool &attempted, bool &skipped) const {
+    const auto &parser{std::get<J>(ps_)};
+    if (J == sizeof...(Ps) || MightStartWith(parser, next)) {
+      if (attempted) {
+        ParseState::Checkpoint prev{state.MakeCheckpoint()};
+        Messages prevMessages{std::move(state.messages())};
+        state.Rollback(backtrack);
+        result = parser.Parse(state);
+        if (!result.has_value()) {
+          state.CombineFailedParses(prev, std::move(prevMessages));
+        }
+      } else {
+        attempted = true;
+        result = parser.Parse(state);
+      }
+    } else {
+      skipped = true;
+    }
+    if constexpr (J < sizeof...(Ps)) {
+      if (!result.has_value()) {
+        ParseFrom<J + 1>(result, state, backtrack, next, attempted, skipped);
+      }
+    }
+  }
+
+  const std::tuple<PA, Ps...> ps_;
+};
+
+template<typename... Ps> inline constexpr auto dispatch(Ps... ps) {
+  return DispatchParser<Ps...>{ps...};
+}
+
 // Skips over optional spaces.  Always succeeds.
 constexpr struct Space {
   using resultType = Success;
@@ -126,11 +234,32 @@ public:
   using resultType = Success;
   constexpr TokenStringMatch(const TokenStringMatch &) = default;
   constexpr TokenStringMatch(const char *str, std::size_t n)
-    : str_{str}, bytes_{n} {}
-  explicit constexpr TokenStringMatch(const char *str) : str_{str} {}
+    : str_{str}, bytes_{n}, packedBytes_{PackableBytes(str, n)},
+      packed_{Pack(str, packedBytes_)} {}
+  explicit constexpr TokenStringMatch(const char *str)
+    : str_{str}, packedBytes_{PackableBytes(str, std::string::npos)},
+      packed_{Pack(str, packedBytes_)} {}
   std::optional<Success> Parse(ParseState &state) const {
     space.Parse(state);
     const char *start{state.GetLocation()};
+    if (packedBytes_ > 0 && state.BytesRemaining() >= sizeof packed_) {
+      // The whole token was packed into an integer; compare all of it
+      // at once.  A mismatch leaves the state just past the first wrong
+      // character, as the character-by-character loop below would.
+      std::uint64_t word;
+      std::memcpy(&word, start, sizeof word);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      word = __builtin_bswap64(word);
+#endif
+      std::uint64_t mask{~std::uint64_t{0} >> (64 - 8 * packedBytes_)};
+      if (std::uint64_t diff{(word ^ packed_) & mask}) {
+        state.UncheckedAdvance(__builtin_ctzll(diff) / 8 + 1);
+        state.Say(start, MessageExpectedText{str_, bytes_});
+        return std::nullopt;
+      }
+      state.UncheckedAdvance(packedBytes_);
+      return Finish(state, start, str_[packedBytes_ - 1]);
+    }
     const char *p{str_};
     std::optional<const char *> at;  // initially empty
     for (std::size_t j{0}; j < bytes_ && *p != '\0'; ++j, ++p) {
@@ -163,6 +292,12 @@ public:
         return std::nullopt;
       }
     }
+    return Finish(state, start, p[-1]);
+  }
+
+private:
+  std::optional<Success> Finish(
+      ParseState &state, const char *start, char last) const {
     if constexpr (MustBeComplete) {
       if (auto after{state.PeekAtNextChar()}) {
         if (IsLegalInIdentifier(**after)) {
@@ -172,16 +307,39 @@ public:
       }
     }
     state.set_anyTokenMatched();
-    if (IsLegalInIdentifier(p[-1])) {
+    if (IsLegalInIdentifier(last)) {
       return spaceCheck.Parse(state);
     } else {
       return space.Parse(state);
     }
   }
 
-private:
+  // Most keywords and punctuation tokens are short and contain no spaces;
+  // such a token is packed at compile time into an integer, first character
+  // in the low byte, so that Parse() can match it with one comparison.
+  // Returns zero for a token that must be matched one character at a time.
+  static constexpr std::size_t PackableBytes(const char *str, std::size_t n) {
+    std::size_t j{0};
+    for (; j < n && str[j] != '\0'; ++j) {
+      if (j == sizeof packed_ || str[j] == ' ') {
+        return 0;
+      }
+    }
+    return j;
+  }
+  static constexpr std::uint64_t Pack(const char *str, std::size_t n) {
+    std::uint64_t result{0};
+    for (std::size_t j{0}; j < n; ++j) {
+      auto ch{static_cast<unsigned char>(ToLowerCaseLetter(str[j]))};
+      result |= std::uint64_t{ch} << (8 * j);
+    }
+    return result;
+  }
+
   const char *const str_;
   const std::size_t bytes_{std::string::npos};
+  const std::size_t packedBytes_;
+  const std::uint64_t packed_;
 };
 
 constexpr TokenStringMatch<> operator""_tok(const char str[], std::size_t n) {
@@ -653,7 +811,45 @@ constexpr auto otherIdChar{underscore / !"'\""_ch ||
     extension<LanguageFeature::PunctuationInNames>("$@"_ch)};
 constexpr auto nonDigitIdChar{letter || otherIdChar};
 constexpr auto rawName{nonDigitIdChar >> many(nonDigitIdChar || digit)};
-TYPE_PARSER(space >> sourced(rawName >> construct<Name>()))
+
+// Names are rescanned often under backtracking, so the common ones that
+// comprise only letters, digits, and underscores are scanned here directly
+// with the same result that rawName would produce.  Anything else (an
+// initial underscore or a '$' or '@' that may be an extension) is left
+// to rawName.
+constexpr struct NameScanner {
+  using resultType = Success;
+  constexpr NameScanner() {}
+  static std::optional<Success> Parse(ParseState &state) {
+    const char *start{state.GetLocation()};
+    std::size_t remaining{state.BytesRemaining()};
+    if (remaining > 0 && IsLowerCaseLetter(*start)) {
+      std::size_t n{1};
+      for (; n < remaining; ++n) {
+        char ch{start[n]};
+        if (ch == '_') {
+          if (n + 1 < remaining &&
+              (start[n + 1] == '\'' || start[n + 1] == '"')) {
+            break;  // kind parameter of a character literal
+          }
+        } else if (!IsLowerCaseLetter(ch) && !IsDecimalDigit(ch)) {
+          break;
+        }
+      }
+      if (n == remaining || (start[n] != '$' && start[n] != '@')) {
+        state.UncheckedAdvance(n);
+        state.set_anyTokenMatched();
+        return {Success{}};
+      }
+    }
+    if (rawName.Parse(state)) {
+      return {Success{}};
+    }
+    return std::nullopt;
+  }
+} nameScanner;
+
+TYPE_PARSER(space >> sourced(nameScanner >> construct<Name>()))
 constexpr auto keyword{construct<Keyword>(name)};
 
 constexpr auto logicalTRUE{
@@ -44,6 +44,12 @@ void TokenSequence::shrink_to_fit() {
   provenances_.shrink_to_fit();
 }
 
+void TokenSequence::reserve(const TokenSequence &that) {
+  start_.reserve(that.start_.size());
+  char_.reserve(that.char_.size());
+  provenances_.reserve(that.provenances_);
+}
+
 void TokenSequence::swap(TokenSequence &that) {
   start_.swap(that.start_);
   std::swap(nextStart_, that.nextStart_);
@@ -206,6 +212,7 @@ bool TokenSequence::HasRedundantBlanks(std::size_t firstChar) const {
 TokenSequence &TokenSequence::RemoveBlanks(std::size_t firstChar) {
   std::size_t tokens{SizeInTokens()};
   TokenSequence result;
+  result.reserve(*this);
   for (std::size_t j{0}; j < tokens; ++j) {
     if (!TokenAt(j).IsBlank() || start_[j] < firstChar) {
       result.Put(*this, j);
@@ -218,6 +225,7 @@ TokenSequence &TokenSequence::RemoveBlanks(std::size_t firstChar) {
 TokenSequence &TokenSequence::RemoveRedundantBlanks(std::size_t firstChar) {
   std::size_t tokens{SizeInTokens()};
   TokenSequence result;
+  result.reserve(*this);
   bool lastWasBlank{false};
   for (std::size_t j{0}; j < tokens; ++j) {
     bool isBlank{TokenAt(j).IsBlank()};
@@ -238,6 +246,7 @@ TokenSequence &TokenSequence::ClipComment(bool skipFirst) {
         skipFirst = false;
       } else {
         TokenSequence result;
+        result.reserve(*this);
         if (j > 0) {
           result.Put(*this, 0, j - 1);
         }
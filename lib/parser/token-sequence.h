@@ -56,10 +56,14 @@ public:
   void clear();
   void pop_back();
   void shrink_to_fit();
+  void reserve(const TokenSequence &);  // room for a copy of another
   void swap(TokenSequence &);
 
   std::size_t SizeInTokens() const { return start_.size(); }
   std::size_t SizeInChars() const { return char_.size(); }
+  const OffsetToProvenanceMappings &provenances() const {
+    return provenances_;
+  }
 
   CharBlock ToCharBlock() const { return {&char_[0], char_.size()}; }
   std::string ToString() const { return ToCharBlock().ToString(); }
@@ -79,6 +83,13 @@ public:
     provenances_.Put({provenance, 1});
   }
 
+  // Appends characters with consecutive provenances to the open token.
+  void PutNextTokenChars(
+      const char *s, std::size_t bytes, Provenance provenance) {
+    char_.insert(char_.end(), s, s + bytes);
+    provenances_.Put({provenance, bytes});
+  }
+
   void CloseToken() {
     start_.emplace_back(nextStart_);
     nextStart_ = char_.size();
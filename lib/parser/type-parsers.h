@@ -17,6 +17,7 @@
 
 #include "basic-parsers.h"
 #include "instrumented-parser.h"
+#include "memoized-parser.h"
 #include "parse-tree.h"
 #include <optional>
 
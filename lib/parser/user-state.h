@@ -34,6 +34,7 @@ namespace Fortran::parser {
 
 class CookedSource;
 class ParsingLog;
+class ParsingMemo;
 class ParseState;
 
 class Success {};  // for when one must return something that's present
@@ -58,6 +59,12 @@ public:
     return *this;
   }
 
+  ParsingMemo *memo() const { return memo_; }
+  UserState &set_memo(ParsingMemo *memo) {
+    memo_ = memo;
+    return *this;
+  }
+
   bool instrumentedParse() const { return instrumentedParse_; }
   UserState &set_instrumentedParse(bool yes) {
     instrumentedParse_ = yes;
@@ -100,6 +107,7 @@ private:
   std::ostream *debugOutput_{nullptr};
 
   ParsingLog *log_{nullptr};
+  ParsingMemo *memo_{nullptr};
   bool instrumentedParse_{false};
 
   std::unordered_map<Label, int> doLabels_;
@@ -132,6 +132,8 @@ void ModFileWriter::Write(const Symbol &symbol) {
   if (!WriteFile(path, GetAsString(symbol))) {
     context_.Say(symbol.name(), "Error writing %s: %s"_err_en_US, path,
         std::strerror(errno));
+  } else {
+    context_.RecordModuleFileWritten(path);
   }
 }
 
@@ -639,18 +641,33 @@ template<typename Iter> static std::string CheckSum(Iter begin, Iter end) {
   return result;
 }
 
-static bool VerifyHeader(const std::string &path) {
+// Return the checksum of a module file if it matches the one in its header.
+static std::optional<std::string> VerifyHeader(const std::string &path) {
   std::fstream stream{path};
   std::string header;
   std::getline(stream, header);
   auto magicLen{strlen(magic)};
   if (header.compare(0, magicLen, magic) != 0) {
-    return false;
+    return std::nullopt;
   }
   std::string expectSum{header.substr(magicLen, 16)};
   std::string actualSum{CheckSum(std::istreambuf_iterator<char>(stream),
       std::istreambuf_iterator<char>())};
-  return expectSum == actualSum;
+  if (expectSum != actualSum) {
+    return std::nullopt;
+  }
+  return actualSum;
+}
+
+std::optional<std::string> GetModFileChecksum(const std::string &path) {
+  std::ifstream stream{path};
+  std::string header;
+  std::getline(stream, header);
+  auto magicLen{strlen(magic)};
+  if (header.compare(0, magicLen, magic) != 0) {
+    return std::nullopt;
+  }
+  return header.substr(magicLen, 16);
 }
 
 static std::string GetHeader(const std::string &all) {
@@ -685,13 +702,16 @@ Scope *ModFileReader::Read(const SourceName &name, Scope *ancestor) {
   if (!path.has_value()) {
     return nullptr;
   }
+  common::PhaseReport::Timer timer{context_.phaseReport(), "ModFileReader"};
   // TODO: We are reading the file once to verify the checksum and then again
   // to parse. Do it only reading the file once.
-  if (!VerifyHeader(*path)) {
+  std::optional<std::string> checkSum{VerifyHeader(*path)};
+  if (!checkSum.has_value()) {
     context_.Say(name,
         "Module file for '%s' has invalid checksum: %s"_err_en_US, name, *path);
     return nullptr;
   }
+  context_.RecordModuleFile(*path, *checkSum);
   parser::Parsing parsing{context_.allSources()};
   parser::Options options;
   options.isModuleFile = true;
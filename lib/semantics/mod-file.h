@@ -18,6 +18,7 @@
 #include "attr.h"
 #include "resolve-names.h"
 #include "../parser/message.h"
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -74,6 +75,10 @@ private:
   std::optional<std::string> FindModFile(
       const SourceName &, const std::string &);
 };
+
+// Return the checksum recorded in the header of a module file,
+// or std::nullopt if it is not a module file.
+std::optional<std::string> GetModFileChecksum(const std::string &path);
 }
 
 #endif
@@ -199,6 +199,8 @@ public:
   const DeclTypeSpec *FindInstantiatedDerivedType(const DerivedTypeSpec &,
       DeclTypeSpec::Category = DeclTypeSpec::TypeDerived) const;
 
+  static const Symbols<1024> &AllSymbols() { return allSymbols; }
+
   bool IsModuleFile() const {
     return kind_ == Kind::Module && symbol_ != nullptr &&
         symbol_->test(Symbol::Flag::ModFile);
@@ -35,6 +35,8 @@
 #include "symbol.h"
 #include "../common/default-kinds.h"
 #include "../parser/parse-tree-visitor.h"
+#include <string>
+#include <type_traits>
 
 namespace Fortran::semantics {
 
@@ -86,12 +88,116 @@ using StatementSemanticsPass2 = SemanticsVisitor<AllocateChecker,
     DeallocateChecker, DoChecker, IfStmtChecker, IoChecker, NullifyChecker,
     OmpStructureChecker, ReturnStmtChecker, StopChecker>;
 
+// Whether a checker class C itself defines Enter or Leave for parse tree
+// nodes of type N, rather than inheriting the empty ones of BaseChecker
+template<typename C, typename N, typename = void>
+struct DefinesEnter : std::false_type {};
+template<typename C, typename N>
+struct DefinesEnter<C, N,
+    std::void_t<decltype(static_cast<void (C::*)(const N &)>(&C::Enter))>>
+  : std::true_type {};
+template<typename C, typename N, typename = void>
+struct DefinesLeave : std::false_type {};
+template<typename C, typename N>
+struct DefinesLeave<C, N,
+    std::void_t<decltype(static_cast<void (C::*)(const N &)>(&C::Leave))>>
+  : std::true_type {};
+
+// The unqualified name of a class, for reports, without RTTI
+template<typename T> static std::string ClassName() {
+  // "... [with T = ns::Name; ...]" from GCC, "... [T = ns::Name]" from clang
+  std::string name{__PRETTY_FUNCTION__};
+  auto start{name.find("T = ")};
+  if (start == std::string::npos) {
+    return name;
+  }
+  start += 4;
+  name = name.substr(start, name.find_first_of(";]", start) - start);
+  auto colons{name.rfind("::")};
+  return colons == std::string::npos ? name : name.substr(colons + 2);
+}
+
+// A SemanticsVisitor for phase reports: in its single walk of the parse
+// tree, the time spent in each Enter or Leave function is charged to the
+// checker that defines it, so that each checker is reported separately.
+template<typename... C> class TimedSemanticsVisitor : public virtual C... {
+public:
+  TimedSemanticsVisitor(SemanticsContext &context)
+    : C{context}..., context_{context} {}
+
+  template<typename N> bool Pre(const N &node) {
+    Enter(node);
+    return true;
+  }
+  template<typename N> void Post(const N &node) { Leave(node); }
+
+  template<typename T> bool Pre(const parser::Statement<T> &node) {
+    context_.set_location(&node.source);
+    Enter(node);
+    return true;
+  }
+  template<typename T> void Post(const parser::Statement<T> &node) {
+    Leave(node);
+    context_.set_location(nullptr);
+  }
+
+  bool Walk(const parser::Program &program) {
+    parser::Walk(program, *this);
+    const common::PhaseReport::Stopwatch *stopwatch{stopwatches_};
+    (stopwatch++->Report(*context_.phaseReport(), ClassName<C>()), ...);
+    return !context_.AnyFatalError();
+  }
+
+private:
+  template<typename N> void Enter(const N &node) {
+    common::PhaseReport::Stopwatch *stopwatch{stopwatches_};
+    (EnterOne<C>(node, *stopwatch++), ...);
+  }
+  template<typename N> void Leave(const N &node) {
+    common::PhaseReport::Stopwatch *stopwatch{stopwatches_};
+    (LeaveOne<C>(node, *stopwatch++), ...);
+  }
+  template<typename ONE, typename N>
+  void EnterOne(const N &node, common::PhaseReport::Stopwatch &stopwatch) {
+    if constexpr (DefinesEnter<ONE, N>::value) {
+      stopwatch.Start();
+      ONE::Enter(node);
+      stopwatch.Stop();
+    }
+  }
+  template<typename ONE, typename N>
+  void LeaveOne(const N &node, common::PhaseReport::Stopwatch &stopwatch) {
+    if constexpr (DefinesLeave<ONE, N>::value) {
+      stopwatch.Start();
+      ONE::Leave(node);
+      stopwatch.Stop();
+    }
+  }
+
+  SemanticsContext &context_;
+  common::PhaseReport::Stopwatch stopwatches_[sizeof...(C)];
+};
+
+template<typename> struct Timed;
+template<typename... C> struct Timed<SemanticsVisitor<C...>> {
+  using Visitor = TimedSemanticsVisitor<C...>;
+};
+
 static bool PerformStatementSemantics(
     SemanticsContext &context, parser::Program &program) {
-  ResolveNames(context, program);
-  RewriteParseTree(context, program);
-  StatementSemanticsPass1{context}.Walk(program);
-  return StatementSemanticsPass2{context}.Walk(program);
+  common::PhaseReport *report{context.phaseReport()};
+  common::PhaseReport::Measure(
+      report, "ResolveNames", [&]() { ResolveNames(context, program); });
+  common::PhaseReport::Measure(report, "RewriteParseTree",
+      [&]() { RewriteParseTree(context, program); });
+  common::PhaseReport::Measure(report, "StatementSemanticsPass1",
+      [&]() { StatementSemanticsPass1{context}.Walk(program); });
+  common::PhaseReport::Timer timer{report, "StatementSemanticsPass2"};
+  if (report != nullptr) {
+    return Timed<StatementSemanticsPass2>::Visitor{context}.Walk(program);
+  } else {
+    return StatementSemanticsPass2{context}.Walk(program);
+  }
 }
 
 SemanticsContext::SemanticsContext(
@@ -168,10 +274,15 @@ Scope &SemanticsContext::FindScope(parser::CharBlock source) {
 }
 
 bool Semantics::Perform() {
-  return ValidateLabels(context_, program_) &&
-      parser::CanonicalizeDo(program_) &&  // force line break
+  common::PhaseReport *report{context_.phaseReport()};
+  common::PhaseReport::Timer timer{report, "Semantics"};
+  return common::PhaseReport::Measure(report, "ValidateLabels",
+             [&]() { return ValidateLabels(context_, program_); }) &&
+      common::PhaseReport::Measure(report, "CanonicalizeDo",
+          [&]() { return parser::CanonicalizeDo(program_); }) &&
       PerformStatementSemantics(context_, program_) &&
-      ModFileWriter{context_}.WriteAll();
+      common::PhaseReport::Measure(report, "ModFileWriter",
+          [&]() { return ModFileWriter{context_}.WriteAll(); });
 }
 
 void Semantics::EmitMessages(std::ostream &os) const {
@@ -16,11 +16,13 @@
 #define FORTRAN_SEMANTICS_SEMANTICS_H_
 
 #include "scope.h"
+#include "../common/phase-report.h"
 #include "../evaluate/common.h"
 #include "../evaluate/intrinsics.h"
 #include "../parser/features.h"
 #include "../parser/message.h"
 #include <iosfwd>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -67,6 +69,16 @@ public:
   parser::Messages &messages() { return messages_; }
   evaluate::FoldingContext &foldingContext() { return foldingContext_; }
   parser::AllSources &allSources() { return allSources_; }
+  // The paths of the module files that have been read, with their checksums
+  const std::map<std::string, std::string> &moduleFilesRead() const {
+    return moduleFilesRead_;
+  }
+  // The paths of the module files that have been written
+  const std::vector<std::string> &moduleFilesWritten() const {
+    return moduleFilesWritten_;
+  }
+  // Where phase timings are accumulated for -ftime-report; may be null
+  common::PhaseReport *phaseReport() const { return phaseReport_; }
 
   SemanticsContext &set_location(const parser::CharBlock *location) {
     location_ = location;
@@ -92,6 +104,10 @@ public:
     warningsAreErrors_ = x;
     return *this;
   }
+  SemanticsContext &set_phaseReport(common::PhaseReport *x) {
+    phaseReport_ = x;
+    return *this;
+  }
 
   const DeclTypeSpec &MakeNumericType(TypeCategory, int kind = 0);
   const DeclTypeSpec &MakeLogicalType(int kind = 0);
@@ -119,6 +135,13 @@ public:
   const Scope &FindScope(parser::CharBlock) const;
   Scope &FindScope(parser::CharBlock);
 
+  void RecordModuleFile(const std::string &path, const std::string &checkSum) {
+    moduleFilesRead_[path] = checkSum;
+  }
+  void RecordModuleFileWritten(const std::string &path) {
+    moduleFilesWritten_.push_back(path);
+  }
+
 private:
   const common::IntrinsicTypeDefaultKinds &defaultKinds_;
   const parser::LanguageFeatureControl &languageFeatures_;
@@ -133,6 +156,9 @@ private:
   Scope globalScope_;
   parser::Messages messages_;
   evaluate::FoldingContext foldingContext_{defaultKinds_};
+  std::map<std::string, std::string> moduleFilesRead_;
+  std::vector<std::string> moduleFilesWritten_;
+  common::PhaseReport *phaseReport_{nullptr};
 
   bool CheckError(bool);
 };
@@ -655,6 +655,18 @@ public:
     return symbol;
   }
 
+  // The number of Symbols made and the memory occupied by their blocks
+  std::size_t size() const {
+    if (blocks_.empty()) {
+      return 0;
+    } else if (nextIndex_ == 0) {
+      return blocks_.size() * BLOCK_SIZE;  // the last block is full
+    } else {
+      return (blocks_.size() - 1) * BLOCK_SIZE + nextIndex_;
+    }
+  }
+  std::size_t HeapBytes() const { return blocks_.size() * sizeof(blockType); }
+
 private:
   using blockType = std::array<Symbol, BLOCK_SIZE>;
   std::list<blockType *> blocks_;
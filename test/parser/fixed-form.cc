@@ -0,0 +1,96 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prescans fixed form sources whose names run into the right margin,
+// across continuation lines, and past tabs, and checks the cooked
+// characters and their provenances.  Then prescans synthetic F77 card
+// images; an optional argument sets their number of lines (default
+// 100000) and reports the prescanning rate.
+
+#include "source-fixture.h"
+#include "../../lib/parser/provenance.h"
+#include "../evaluate/testing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Fortran::parser;
+
+// Prescans fixed form text and returns the cooked characters, having
+// checked the provenances of some of them, given as pairs of offsets into
+// the cooked characters and the source text.
+static std::string Prescan(const std::string &text,
+    std::vector<std::pair<std::size_t, std::size_t>> origins = {},
+    double *seconds = nullptr) {
+  testing::PrescannedSource prescanned{text, ".f", true};
+  if (seconds != nullptr) {
+    *seconds = prescanned.seconds();
+  }
+  TEST(prescanned.messages().empty());
+  const CookedSource &cooked{prescanned.cooked()};
+  const std::string &data{cooked.data()};
+  for (auto [at, from] : origins) {
+    TEST(at < data.size());
+    auto provenance{cooked.GetProvenanceRange(CharBlock{&data[at], 1})};
+    TEST(provenance.has_value() &&
+        provenance->start() == prescanned.range().start() + from)
+    ("cooked character %zd", at);
+  }
+  return data;
+}
+
+int main(int argc, const char *argv[]) {
+  // Names that reach the right margin are cut off at column 72.
+  MATCH("      abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz"
+        "abcdefghijklmn\n",
+      Prescan("      ABCDEFGHIJKLMNOPQRSTUVWXYZABCDEFGHIJKLMNOPQRSTUVWXYZ"
+              "ABCDEFGHIJKLMNOP\n"));
+  // A name continues across continuation lines; tabs lift the margin.
+  MATCH("      x=longnamenumbertwo+y\n",
+      Prescan("      X = LONGNAME\n     1NUMBERTWO\n     2 + Y\n"));
+  MATCH("      x=tabbedlinewithaverylongidentifierthatgoespastcolumnseventytwo"
+        "continued\n",
+      Prescan("\tX = TABBEDLINEWITHAVERYLONGIDENTIFIERTHATGOESPASTCOLUMNSEVENT"
+              "YTWO\n\t1CONTINUED\n"));
+  // Names keep the provenances of their source characters.
+  MATCH("      abc=defghi\n",
+      Prescan("      ABC = DEFG\n     &HI\n",
+          {{6, 6}, {10, 12}, {13, 15}, {14, 23}}));
+  // Names don't swallow a following character literal or Hollerith.
+  MATCH("      datah/3hABC/,k_'Xy'\n",
+      Prescan("      DATA H /3HABC/, K_'Xy'\n"));
+
+  std::size_t lines{100000};
+  if (argc > 1) {
+    lines = std::strtoul(argv[1], nullptr, 10);
+  }
+  std::string cards;
+  for (std::size_t j{0}; j < lines; j += 4) {
+    cards += "C     UPDATE THE TEMPERATURE\n"
+             "      TEMPERATURE(I) = TEMPERATURE(I) + COEFFICIENT * (FLUX(I+1)"
+             "\n     &   - FLUX(I-1)) / DELTAX\n"
+             "      IF (ABS(RESIDUAL) .LT. TOLERANCE) GO TO 100\n";
+  }
+  double seconds{0};
+  std::string cooked{Prescan(cards, {}, &seconds)};
+  TEST(cooked.find("temperature(i)=temperature(i)+coefficient*(flux(i+1)-"
+                   "flux(i-1))/deltax\n") == 6);
+  if (argc > 1) {
+    std::printf("prescanned %zd fixed form lines in %.4fs (%.0f lines/s)\n",
+        lines, seconds, lines / seconds);
+  }
+  return testing::Complete();
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests the line start indexing and carriage return removal of source
+// files against the memchr()-based code that they replaced, and compares
+// their speeds.  An optional argument sets the size of the synthetic
+// sources in MiB (default 1) and reports the speeds; e.g.,
+// "line-starts-test 512".
+
+#include "source-fixture.h"
+#include "../../lib/parser/source.h"
+#include "../evaluate/testing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Fortran::parser;
+
+static std::vector<std::size_t> ReferenceFindLineStarts(
+    const char *source, std::size_t bytes) {
+  std::vector<std::size_t> result;
+  if (bytes > 0) {
+    std::size_t at{0};
+    do {
+      result.push_back(at);
+      const void *vp{static_cast<const void *>(&source[at])};
+      const void *vnl{std::memchr(vp, '\n', bytes - at)};
+      const char *nl{static_cast<const char *>(vnl)};
+      at = nl + 1 - source;
+    } while (at < bytes);
+    result.shrink_to_fit();
+  }
+  return result;
+}
+
+static std::size_t ReferenceRemoveCarriageReturns(
+    char *buffer, std::size_t bytes) {
+  std::size_t wrote{0};
+  char *p{buffer};
+  while (bytes > 0) {
+    void *vp{static_cast<void *>(p)};
+    void *crvp{std::memchr(vp, '\r', bytes)};
+    char *crcp{static_cast<char *>(crvp)};
+    if (crcp == nullptr) {
+      std::memmove(buffer + wrote, p, bytes);
+      wrote += bytes;
+      break;
+    }
+    std::size_t chunk = crcp - p;
+    std::memmove(buffer + wrote, p, chunk);
+    wrote += chunk;
+    p += chunk + 1;
+    bytes -= chunk + 1;
+  }
+  return wrote;
+}
+
+// Lines of varying lengths resembling generated Fortran
+static std::string MakeSource(std::size_t bytes, const char *lineEnding) {
+  std::string result;
+  result.reserve(bytes + 128);
+  for (unsigned j{0}; result.size() < bytes; ++j) {
+    result += "      x" + std::to_string(j) + " = ";
+    for (unsigned k{0}; k < j % 23; ++k) {
+      result += "y(" + std::to_string(k) + ") + ";
+    }
+    result += '0';
+    result += lineEnding;
+  }
+  return result;
+}
+
+using testing::Seconds;
+
+static void TestFindLineStarts(const std::string &source, bool report) {
+  std::vector<std::size_t> want, got;
+  double reference{Seconds([&]() {
+    // The replaced code made a separate pass to look for carriage returns.
+    TEST(std::memchr(source.data(), '\r', source.size()) == nullptr);
+    want = ReferenceFindLineStarts(source.data(), source.size());
+  })};
+  double fused{Seconds([&]() {
+    TEST(FindLineStarts(source.data(), source.size(), got));
+  })};
+  TEST(want == got)("%zd vs %zd line starts", want.size(), got.size());
+  if (report) {
+    std::printf("FindLineStarts: %zd bytes, %zd lines: %.4fs (was %.4fs)\n",
+        source.size(), got.size(), fused, reference);
+  }
+}
+
+static void TestRemoveCarriageReturns(const std::string &source, bool report) {
+  std::string expect{source}, actual{source};
+  std::vector<std::size_t> want, got;
+  double reference{Seconds([&]() {
+    expect.resize(ReferenceRemoveCarriageReturns(&expect[0], expect.size()));
+    want = ReferenceFindLineStarts(expect.data(), expect.size());
+  })};
+  double fused{Seconds([&]() {
+    actual.resize(RemoveCarriageReturns(&actual[0], actual.size(), got));
+  })};
+  TEST(expect == actual);
+  TEST(want == got)("%zd vs %zd line starts", want.size(), got.size());
+  std::vector<std::size_t> none;
+  TEST(!FindLineStarts(source.data(), source.size(), none));
+  if (report) {
+    std::printf(
+        "RemoveCarriageReturns: %zd bytes, %zd lines: %.4fs (was %.4fs)\n",
+        source.size(), got.size(), fused, reference);
+  }
+}
+
+int main(int argc, const char *argv[]) {
+  std::size_t mebibytes{1};
+  if (argc > 1) {
+    mebibytes = std::strtoul(argv[1], nullptr, 10);
+  }
+  // Short and irregular cases exercise the scalar tails of the scans.
+  for (const char *text : {"\n", "a\n", "\n\n", "ab\ncd\n\n",
+           "0123456789abcdef0123456789abcdef\n", "\r\n", "a\r\nb\rc\r\r\n"}) {
+    std::string source{text};
+    std::vector<std::size_t> got;
+    if (source.find('\r') == std::string::npos) {
+      TEST(FindLineStarts(source.data(), source.size(), got));
+      TEST(got == ReferenceFindLineStarts(source.data(), source.size()))
+      ("'%s'", text);
+    } else {
+      std::string expect{source};
+      expect.resize(ReferenceRemoveCarriageReturns(&expect[0], expect.size()));
+      source.resize(RemoveCarriageReturns(&source[0], source.size(), got));
+      TEST(source == expect);
+      TEST(got == ReferenceFindLineStarts(expect.data(), expect.size()));
+    }
+  }
+  std::vector<std::size_t> none;
+  TEST(FindLineStarts(nullptr, 0, none) && none.empty());
+  TestFindLineStarts(MakeSource(mebibytes << 20, "\n"), argc > 1);
+  TestRemoveCarriageReturns(MakeSource(mebibytes << 20, "\r\n"), argc > 1);
+  return testing::Complete();
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Parses with a small grammar whose alternatives share a recursive prefix,
+// in nested message contexts, with and without a memo table, and checks
+// that memoized failures leave the same state behind while keeping the
+// number of attempts linear in the depth of nesting.
+
+#include "../../lib/parser/basic-parsers.h"
+#include "../../lib/parser/memoized-parser.h"
+#include "../../lib/parser/parse-state.h"
+#include "../../lib/parser/provenance.h"
+#include "../../lib/parser/token-parsers.h"
+#include "../../lib/parser/user-state.h"
+#include "../evaluate/testing.h"
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+
+using namespace Fortran::parser;
+
+static std::size_t attempts{0};
+
+// nest -> ( nest ) | ( nest ] | z
+struct Nest {
+  using resultType = Success;
+  static std::optional<Success> Parse(ParseState &);
+};
+
+constexpr auto nest{memoized("nest"_en_US, Nest{})};
+
+std::optional<Success> Nest::Parse(ParseState &state) {
+  ++attempts;
+  static constexpr auto parser{inContext("nest"_en_US,
+      "(" >> nest / ")" || "(" >> nest / "]" ||
+          "z"_tok >> construct<Success>())};
+  return parser.Parse(state);
+}
+
+struct Outcome {
+  bool operator==(const Outcome &that) const {
+    return ok == that.ok && at == that.at &&
+        anyTokenMatched == that.anyTokenMatched;
+  }
+  bool ok;
+  std::size_t at;
+  bool anyTokenMatched;
+  std::size_t messages;
+};
+
+static Outcome Parse(const std::string &text, bool memoize) {
+  AllSources allSources;
+  CookedSource cooked{allSources};
+  cooked.Put(text);
+  cooked.PutProvenance(allSources.AddCompilerInsertion(text));
+  cooked.Marshal();
+  UserState userState{cooked, LanguageFeatureControl{}};
+  ParsingMemo memo;
+  if (memoize) {
+    userState.set_memo(&memo);
+  }
+  ParseState state{cooked};
+  state.set_userState(&userState);
+  attempts = 0;
+  bool ok{nest.Parse(state).has_value()};
+  return Outcome{ok,
+      static_cast<std::size_t>(state.GetLocation() - cooked.data().data()),
+      state.anyTokenMatched(),
+      static_cast<std::size_t>(std::distance(
+          state.messages().begin(), state.messages().end()))};
+}
+
+int main() {
+  for (const char *text : {"z", "(z)", "(z]", "((z])", "((z)]", "((z)", "(y)",
+           "((((((((z)))))))]", "y"}) {
+    Outcome plain{Parse(text, false)};
+    std::size_t plainAttempts{attempts};
+    Outcome memoized{Parse(text, true)};
+    TEST(memoized == plain)("'%s'", text);
+    // Replayed messages share the contexts of the originals, so they
+    // can merge with duplicates that would otherwise remain distinct.
+    TEST(memoized.messages > 0 || plain.messages == 0)("'%s'", text);
+    TEST(memoized.messages <= plain.messages)("'%s'", text);
+    TEST(attempts <= plainAttempts)("'%s'", text);
+  }
+  MATCH(true, Parse("((z])", true).ok);
+  MATCH(false, Parse("((z)", true).ok);
+
+  // Unclosed nesting: each level tries both alternatives, so the
+  // unmemoized parse makes 2**(depth+1)-1 attempts.
+  constexpr int depth{16};
+  std::string unclosed(depth, '(');
+  unclosed += 'z';
+  Outcome plain{Parse(unclosed, false)};
+  MATCH((std::size_t{2} << depth) - 1, attempts);
+  // Memoized, only the innermost success is repeated.
+  Outcome memoized{Parse(unclosed, true)};
+  MATCH(depth + 2, attempts);
+  TEST(memoized == plain);
+  TEST(!memoized.ok && memoized.anyTokenMatched);
+  MATCH(unclosed.size(), memoized.at);
+  return testing::Complete();
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Parses sources of many program units, some of which have internal and
+// module subprograms, separate module procedures, interface bodies, or
+// derived types with type-bound procedures whose END and CONTAINS
+// statements look like those of program units, both serially and in
+// parallel, and checks that the parse trees and messages are the same and
+// that the sources were actually split.
+
+#include "source-fixture.h"
+#include "../../lib/parser/message.h"
+#include "../../lib/parser/parsing.h"
+#include "../../lib/parser/provenance.h"
+#include "../../lib/parser/unparse.h"
+#include "../evaluate/testing.h"
+#include <sstream>
+#include <string>
+
+using namespace Fortran::parser;
+
+struct Outcome {
+  bool consumedWholeFile;
+  bool parsed;
+  std::string unparsed;
+  std::string messages;
+  std::size_t ranges;
+};
+
+static Outcome Parse(const std::string &text, int threads) {
+  AllSources allSources;
+  Parsing parsing{allSources};
+  Options options;
+  options.parseThreads = threads;
+  parsing.Prescan(testing::TemporarySource{text, ".f90"}.path(), options);
+  parsing.Parse();
+  Outcome outcome{parsing.consumedWholeFile(),
+      parsing.parseTree().has_value(), "", "", parsing.parsedRanges()};
+  if (outcome.parsed) {
+    std::ostringstream unparsed;
+    Unparse(unparsed, *parsing.parseTree());
+    outcome.unparsed = unparsed.str();
+  }
+  std::ostringstream messages;
+  parsing.messages().Emit(messages, parsing.cooked());
+  outcome.messages = messages.str();
+  return outcome;
+}
+
+static void Compare(const std::string &text, const char *what) {
+  Outcome serial{Parse(text, 1)};
+  for (int threads : {2, 3, 8}) {
+    Outcome parallel{Parse(text, threads)};
+    MATCH(serial.consumedWholeFile, parallel.consumedWholeFile)
+    ("%s, %d threads", what, threads);
+    MATCH(serial.parsed, parallel.parsed)("%s, %d threads", what, threads);
+    MATCH(serial.unparsed, parallel.unparsed)
+    ("%s, %d threads", what, threads);
+    MATCH(serial.messages, parallel.messages)
+    ("%s, %d threads", what, threads);
+    TEST(parallel.ranges > 1)("%s, %d threads", what, threads);
+  }
+}
+
+// Program units, with '#' to be replaced by a number to make them distinct
+static const std::string unitsTemplate{"module m#\n"
+                                       "  type, abstract :: base\n"
+                                       "  contains\n"
+                                       "    procedure(f), deferred :: d\n"
+                                       "  end type\n"
+                                       "  type, extends(base) :: concrete\n"
+                                       "  contains\n"
+                                       "    procedure :: d => f\n"
+                                       "  end type concrete\n"
+                                       "  interface\n"
+                                       "    subroutine ext#(x)\n"
+                                       "      real :: x\n"
+                                       "    end subroutine\n"
+                                       "    module subroutine p\n"
+                                       "    end subroutine\n"
+                                       "  end interface\n"
+                                       "contains\n"
+                                       "  subroutine s\n"
+                                       "  contains\n"
+                                       "    subroutine t\n"
+                                       "    end subroutine t\n"
+                                       "  end subroutine s\n"
+                                       "  function f()\n"
+                                       "    f = 1.\n"
+                                       "  end function\n"
+                                       "end module\n"
+                                       "submodule (m#) sm#\n"
+                                       "contains\n"
+                                       "  module procedure p\n"
+                                       "  end procedure p\n"
+                                       "end submodule\n"
+                                       "subroutine host#\n"
+                                       "contains\n"
+                                       "  subroutine inner\n"
+                                       "  end\n"
+                                       "end subroutine\n"
+                                       "\n"
+                                       "function g#(x)\n"
+                                       "  g# = x\n"
+                                       "end function g#\n"};
+
+int main() {
+  std::string units;
+  for (int j{0}; j < 40; ++j) {
+    for (char ch : unitsTemplate) {
+      if (ch == '#') {
+        units += std::to_string(j);
+      } else {
+        units += ch;
+      }
+    }
+  }
+  Compare(units + "program main\n  call host0\nend program\n", "valid");
+  Compare(units + "\n\n", "trailing blank lines");
+  // A syntax error in the middle, and a unit left unfinished at the end
+  std::string middle{units};
+  middle.insert(
+      middle.find("subroutine host20"), "subroutine bad\n  x = (\nend\n");
+  Compare(middle, "error");
+  Compare(units + "subroutine unfinished\n  x = 1\n", "unfinished");
+  return testing::Complete();
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Resolves the provenance and line number of every character of a
+// prescanned source, first in order (as semantics and message emission
+// tend to do) and then in a scattered order that defeats the lookup
+// caches, and checks that both agree, also when both orders are resolved
+// at once on separate threads.  An optional argument sets the
+// number of lines in the synthetic source (default 20000) and reports the
+// times taken.
+
+#include "source-fixture.h"
+#include "../../lib/parser/provenance.h"
+#include "../evaluate/testing.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Fortran::parser;
+
+int main(int argc, const char *argv[]) {
+  std::size_t lines{20000};
+  if (argc > 1) {
+    lines = std::strtoul(argv[1], nullptr, 10);
+  }
+  // Alternating macro calls give the source many origins.
+  std::string text{"#define ONE 1\n#define TWO(x) (x+2)\n"};
+  for (std::size_t j{0}; j < lines; ++j) {
+    text += "x" + std::to_string(j) + " = ONE + TWO(y" + std::to_string(j) +
+        ") * ONE\n";
+  }
+  testing::PrescannedSource prescanned{text, ".F90"};
+  const AllSources &allSources{prescanned.allSources()};
+  const CookedSource &cooked{prescanned.cooked()};
+  TEST(prescanned.messages().empty());
+
+  const std::string &data{cooked.data()};
+  std::size_t chars{data.size()};
+  std::vector<std::size_t> inOrder(chars), scattered(chars);
+  auto Resolve{[&](std::size_t at) {
+    auto provenance{cooked.GetProvenanceRange(CharBlock{&data[at], 1})};
+    return provenance.has_value()
+        ? static_cast<std::size_t>(
+              allSources.GetLineNumber(provenance->start()))
+        : 0;
+  }};
+  double sequential{testing::Seconds([&]() {
+    for (std::size_t at{0}; at < chars; ++at) {
+      inOrder[at] = Resolve(at);
+    }
+  })};
+  constexpr std::size_t stride{7919};  // prime
+  double random{testing::Seconds([&]() {
+    for (std::size_t j{0}, at{0}; j < chars; ++j, at = (at + stride) % chars) {
+      scattered[at] = Resolve(at);
+    }
+  })};
+  TEST(chars % stride != 0);
+  TEST(inOrder == scattered);
+  std::vector<std::size_t> concurrentInOrder(chars), concurrentScattered(chars);
+  std::thread thread{[&]() {
+    for (std::size_t at{0}; at < chars; ++at) {
+      concurrentInOrder[at] = Resolve(at);
+    }
+  }};
+  for (std::size_t j{0}, at{0}; j < chars; ++j, at = (at + stride) % chars) {
+    concurrentScattered[at] = Resolve(at);
+  }
+  thread.join();
+  TEST(concurrentInOrder == inOrder);
+  TEST(concurrentScattered == inOrder);
+  TEST(!inOrder.empty() && inOrder.back() == lines + 2);
+  if (argc > 1) {
+    std::printf("resolved %zd characters in order in %.4fs, "
+                "scattered in %.4fs\n",
+        chars, sequential, random);
+  }
+  return testing::Complete();
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FORTRAN_TEST_PARSER_SOURCE_FIXTURE_H_
+#define FORTRAN_TEST_PARSER_SOURCE_FIXTURE_H_
+
+// Source files for the parser tests and the timing of their microbenchmarks
+
+#include "../../lib/parser/message.h"
+#include "../../lib/parser/preprocessor.h"
+#include "../../lib/parser/prescan.h"
+#include "../../lib/parser/provenance.h"
+#include "../evaluate/testing.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace testing {
+
+// The wall clock time taken by a call to f(), in seconds
+template<typename A> double Seconds(A &&f) {
+  auto start{std::chrono::steady_clock::now()};
+  f();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// A source text written to a temporary file, whose name ends with a
+// suffix (e.g., ".f90") that determines its source form for the driver;
+// the file is removed when the TemporarySource is destroyed.
+class TemporarySource {
+public:
+  TemporarySource(const std::string &text, const std::string &suffix)
+    : path_{"/tmp/f18-test-XXXXXX" + suffix} {
+    int fd{mkstemps(&path_[0], static_cast<int>(suffix.size()))};
+    TEST(fd >= 0);
+    close(fd);
+    std::ofstream{path_} << text;
+  }
+  TemporarySource(const TemporarySource &) = delete;
+  ~TemporarySource() { unlink(path_.c_str()); }
+
+  const std::string &path() const { return path_; }
+
+private:
+  std::string path_;
+};
+
+// A source text prescanned as a main source file
+class PrescannedSource {
+public:
+  PrescannedSource(const std::string &text, const std::string &suffix,
+      bool fixedForm = false) {
+    TemporarySource file{text, suffix};
+    std::stringstream error;
+    const auto *source{allSources_.Open(file.path(), &error)};
+    TEST(source != nullptr)("%s", error.str().data());
+    if (source == nullptr) {
+      return;
+    }
+    range_ = allSources_.AddIncludedFile(*source, range_);
+    Fortran::parser::Preprocessor preprocessor{allSources_};
+    seconds_ = Seconds([&]() {
+      Fortran::parser::Prescanner{messages_, cooked_, preprocessor,
+          Fortran::parser::LanguageFeatureControl{}}
+          .set_fixedForm(fixedForm)
+          .Prescan(range_);
+      cooked_.Marshal();
+    });
+  }
+  PrescannedSource(const PrescannedSource &) = delete;
+
+  const Fortran::parser::AllSources &allSources() const { return allSources_; }
+  const Fortran::parser::CookedSource &cooked() const { return cooked_; }
+  const Fortran::parser::Messages &messages() const { return messages_; }
+  // The provenances of the characters of the source file
+  Fortran::parser::ProvenanceRange range() const { return range_; }
+  double seconds() const { return seconds_; }  // spent prescanning
+
+private:
+  Fortran::parser::AllSources allSources_;
+  Fortran::parser::CookedSource cooked_{allSources_};
+  Fortran::parser::Messages messages_;
+  Fortran::parser::ProvenanceRange range_;
+  double seconds_{0};
+};
+}
+#endif  // FORTRAN_TEST_PARSER_SOURCE_FIXTURE_H_
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compile a source file that uses module m repeatedly with a front end
+# cache (-fcache-dir), and check that the cached result is used only while
+# the module file for m is unchanged: not before m.mod exists, then after
+# it is written, and not again after it changes.
+
+srcdir=$(dirname $0)
+source $srcdir/common.sh
+F18_OPTIONS="-fdebug-semantics -fparse-only -fcache-dir=cache -v"
+
+log=$temp/log
+cp $src $temp/use.f90
+
+function run_f18 {
+  (cd $temp && $F18 $F18_OPTIONS $1)
+}
+
+function write_module {
+  printf 'module m\n  integer, parameter :: n = %d\nend\n' $1 > $temp/m.f90
+  run_f18 m.f90 > /dev/null 2>&1 || die "could not compile m.f90"
+}
+
+# compile <expected status> <expected use of the cache: hit or miss> <when>
+function compile {
+  run_f18 use.f90 > $log 2>&1
+  status=$?
+  if grep -q 'using cached front end result for use.f90' $log; then
+    result=hit
+  else
+    result=miss
+  fi
+  if [[ $status != $1 || $result != $2 ]]; then
+    echo "$3: expected status $1 and a cache $2," \
+      "got status $status and a cache $result"
+    cat $log
+    echo FAIL
+    exit 1
+  fi
+}
+
+compile 1 miss "without m.mod"
+write_module 1
+compile 0 miss "after m.mod appears"
+compile 0 hit "with m.mod unchanged"
+write_module 2
+compile 0 miss "after m.mod changes"
+compile 0 hit "with m.mod unchanged again"
+echo PASS
@@ -15,6 +15,7 @@
 // Temporary Fortran front end driver main program for development scaffolding.
 
 #include "../../lib/common/default-kinds.h"
+#include "../../lib/common/phase-report.h"
 #include "../../lib/evaluate/expression.h"
 #include "../../lib/parser/characters.h"
 #include "../../lib/parser/dump-parse-tree.h"
@@ -26,21 +27,38 @@
 #include "../../lib/parser/provenance.h"
 #include "../../lib/parser/unparse.h"
 #include "../../lib/semantics/expression.h"
+#include "../../lib/semantics/mod-file.h"
 #include "../../lib/semantics/semantics.h"
 #include "../../lib/semantics/unparse-with-symbols.h"
+#include <algorithm>
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
+#include <csignal>
 #include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <list>
+#include <map>
 #include <memory>
+#include <new>
 #include <optional>
+#include <poll.h>
+#include <set>
 #include <stdlib.h>
+#include <sstream>
 #include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 static std::list<std::string> argList(int argc, char *const argv[]) {
   std::list<std::string> result;
@@ -50,6 +68,42 @@ static std::list<std::string> argList(int argc, char *const argv[]) {
   return result;
 }
 
+// Replacements for the global operator new and delete that count heap
+// allocations for -fmemory-report.  The other forms of new and delete
+// are implemented by the library in terms of these.  Counting is off
+// unless a memory report was requested, so that other compilations pay
+// for no more than a test of countAllocations.  Blocks allocated before
+// counting began may be freed while it is on, so liveBytes is meaningful
+// only as a difference.
+static bool countAllocations{false};
+
+void *operator new(std::size_t bytes) {
+  void *p{std::malloc(bytes > 0 ? bytes : 1)};
+  if (p == nullptr) {
+    Fortran::common::die("out of memory allocating %zu bytes", bytes);
+  }
+  if (countAllocations) {
+    auto &counts{Fortran::common::allocationCounts};
+    counts.allocations.fetch_add(1, std::memory_order_relaxed);
+    counts.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+#ifdef __GLIBC__
+    counts.liveBytes.fetch_add(
+        malloc_usable_size(p), std::memory_order_relaxed);
+#endif
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+#ifdef __GLIBC__
+  if (countAllocations && p != nullptr) {
+    Fortran::common::allocationCounts.liveBytes.fetch_sub(
+        malloc_usable_size(p), std::memory_order_relaxed);
+  }
+#endif
+  std::free(p);
+}
+
 struct MeasurementVisitor {
   template<typename A> bool Pre(const A &) { return true; }
   template<typename A> void Post(const A &) {
@@ -59,11 +113,58 @@ struct MeasurementVisitor {
   size_t objects{0}, bytes{0};
 };
 
-void MeasureParseTree(const Fortran::parser::Program &program) {
+// The byte count of the visitor includes nested members more than once and
+// misses the heap behind lists and strings; heapBytes, the growth of the
+// heap while parsing, is more accurate when it is known.
+void MeasureParseTree(
+    const Fortran::parser::Program &program, std::size_t heapBytes) {
   MeasurementVisitor visitor;
   Fortran::parser::Walk(program, visitor);
   std::cout << "Parse tree comprises " << visitor.objects
-            << " objects and occupies " << visitor.bytes << " total bytes.\n";
+            << " objects and occupies " << visitor.bytes << " total bytes";
+  if (heapBytes > 0) {
+    std::cout << " (" << heapBytes << " bytes of heap)";
+  }
+  std::cout << ".\n";
+}
+
+void MeasureScopes(const Fortran::semantics::Scope &scope,
+    std::size_t &scopes, std::size_t &bytes) {
+  ++scopes;
+  using Entry = Fortran::semantics::Scope::const_iterator::value_type;
+  bytes += sizeof scope + scope.size() * sizeof(Entry);
+  for (const auto &child : scope.children()) {
+    MeasureScopes(child, scopes, bytes);
+  }
+}
+
+// Records the sizes of the data structures of a compilation for
+// -fmemory-report.
+void MeasureDataStructures(Fortran::common::PhaseReport &report,
+    Fortran::parser::Parsing &parsing, std::size_t parseTreeBytes,
+    Fortran::semantics::SemanticsContext *context) {
+  const Fortran::parser::CookedSource &cooked{parsing.cooked()};
+  report.AddSize("cooked source", 1, cooked.data().capacity());
+  report.AddSize("provenance maps", 1,
+      cooked.provenanceMap().HeapBytes() + cooked.allSources().HeapBytes());
+  if (const auto &parseTree{parsing.parseTree()}) {
+    MeasurementVisitor visitor;
+    Fortran::parser::Walk(*parseTree, visitor);
+    report.AddSize("parse tree", visitor.objects, parseTreeBytes);
+  }
+  auto messages{static_cast<std::size_t>(std::distance(
+      parsing.messages().begin(), parsing.messages().end()))};
+  if (context != nullptr) {
+    const auto &symbols{Fortran::semantics::Scope::AllSymbols()};
+    report.AddSize("symbols", symbols.size(), symbols.HeapBytes());
+    std::size_t scopes{0}, scopeBytes{0};
+    MeasureScopes(context->globalScope(), scopes, scopeBytes);
+    report.AddSize("scopes", scopes, scopeBytes);
+    messages += std::distance(
+        context->messages().begin(), context->messages().end());
+  }
+  report.AddSize(
+      "messages", messages, messages * sizeof(Fortran::parser::Message));
 }
 
 std::vector<std::string> filesToDelete;
@@ -99,6 +200,15 @@ struct DriverOptions {
   bool debugSemantics{false};
   bool measureTree{false};
   bool unparseTypedExprsToPGF90{false};
+  int jobs{1};  // -j N
+  std::string serverSocket;  // --server path
+  bool moduleOrder{false};  // -fmodule-order
+  bool batch{false};  // -fbatch
+  std::string cacheDirectory;  // -fcache-dir=dir, or F18_CACHE_DIR
+  std::optional<bool> pipeToCompiler;  // -f[no-]pipe-to-compiler
+  bool timeReport{false};  // -ftime-report
+  bool memoryReport{false};  // -fmemory-report
+  bool reportInJSON{false};  // -ftime-report=json, -fmemory-report=json
   std::vector<std::string> pgf90Args;
   const char *prefix{nullptr};
 };
@@ -142,6 +252,25 @@ void RunOtherCompiler(DriverOptions &driver, char *source, char *relo) {
   Exec(argv, driver.verbose);
 }
 
+// Runs a compiler (gfortran) that reads free form Fortran from its
+// standard input.
+void RunOtherCompilerOnStandardInput(DriverOptions &driver, char *relo) {
+  std::vector<char *> argv;
+  for (size_t j{0}; j < driver.pgf90Args.size(); ++j) {
+    argv.push_back(driver.pgf90Args[j].data());
+  }
+  char dashC[3] = "-c", dashO[3] = "-o", freeForm[] = "-ffree-form";
+  char dashX[3] = "-x", language[4] = "f95", dash[2] = "-";
+  argv.push_back(dashC);
+  argv.push_back(dashO);
+  argv.push_back(relo);
+  argv.push_back(freeForm);
+  argv.push_back(dashX);
+  argv.push_back(language);
+  argv.push_back(dash);
+  Exec(argv, driver.verbose);
+}
+
 std::string RelocatableName(const DriverOptions &driver, std::string path) {
   if (driver.compileOnly && !driver.outputPath.empty()) {
     return driver.outputPath;
@@ -162,18 +291,62 @@ std::string RelocatableName(const DriverOptions &driver, std::string path) {
 
 int exitStatus{EXIT_SUCCESS};
 
-std::string CompileFortran(std::string path, Fortran::parser::Options options,
-    DriverOptions &driver,
-    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
-  Fortran::parser::AllSources allSources;
-  allSources.set_encoding(driver.encoding);
-  Fortran::semantics::SemanticsContext semanticsContext{
-      defaultKinds, options.features, allSources};
-  semanticsContext.set_moduleDirectory(driver.moduleDirectory)
-      .set_moduleFileSuffix(driver.moduleFileSuffix)
-      .set_searchDirectories(driver.searchDirectories)
-      .set_warnOnNonstandardUsage(driver.warnOnNonstandardUsage)
-      .set_warningsAreErrors(driver.warningsAreErrors);
+// Phase timings and memory use of all compilations (-ftime-report,
+// -fmemory-report)
+Fortran::common::PhaseReport phaseReport;
+
+void EmitPhaseReport(const DriverOptions &driver) {
+  if (driver.reportInJSON) {
+    phaseReport.DumpJSON(std::cerr);
+  } else {
+    if (driver.timeReport) {
+      phaseReport.Dump(std::cerr);
+    }
+    if (driver.memoryReport) {
+      phaseReport.DumpMemory(std::cerr);
+    }
+  }
+}
+
+// When running under a compile server (--server), the server's semantics
+// context, whose global scope holds the modules already read from module
+// files; it is used when the client's configuration matches the server's.
+Fortran::semantics::SemanticsContext *residentContext{nullptr};
+std::string residentConfiguration;
+int moduleReportFd{-1};  // compilations report modules read to the server
+
+// A module defined by the source being compiled replaces any resident
+// module of the same name.
+void ForgetResidentModules(const Fortran::parser::Program &program) {
+  auto &globalScope{residentContext->globalScope()};
+  for (const auto &unit : program.v) {
+    if (const auto *module{std::get_if<
+            Fortran::common::Indirection<Fortran::parser::Module>>(&unit.u)}) {
+      const auto &stmt{
+          std::get<Fortran::parser::Statement<Fortran::parser::ModuleStmt>>(
+              module->value().t)};
+      globalScope.erase(stmt.statement.v.source);
+    }
+  }
+}
+
+// Tells the compile server the names of the modules that were read from
+// module files, so that it can keep them resident for later compilations.
+void ReportModulesRead(Fortran::semantics::SemanticsContext &context) {
+  std::string names;
+  for (const auto &scope : context.globalScope().children()) {
+    if (scope.IsModuleFile()) {
+      names += scope.name().ToString() + '\n';
+    }
+  }
+  if (!names.empty() &&
+      write(moduleReportFd, names.data(), names.size()) < 0) {
+    moduleReportFd = -1;
+  }
+}
+
+void SetSourceOptions(const std::string &path,
+    Fortran::parser::Options &options, const DriverOptions &driver) {
   if (!driver.forcedForm) {
     auto dot{path.rfind(".")};
     if (dot != std::string::npos) {
@@ -182,8 +355,414 @@ std::string CompileFortran(std::string path, Fortran::parser::Options options,
     }
   }
   options.searchDirectories = driver.searchDirectories;
-  Fortran::parser::Parsing parsing{semanticsContext.allSources()};
-  parsing.Prescan(path, options);
+}
+
+bool WriteFully(int fd, const char *data, std::size_t bytes) {
+  while (bytes > 0) {
+    ssize_t wrote{write(fd, data, bytes)};
+    if (wrote < 0 && errno == EINTR) {
+      continue;
+    }
+    if (wrote <= 0) {
+      return false;
+    }
+    data += wrote;
+    bytes -= wrote;
+  }
+  return true;
+}
+
+// An output stream buffer that writes to a file descriptor, such as a pipe
+class FileDescriptorBuffer : public std::streambuf {
+public:
+  explicit FileDescriptorBuffer(int fd) : fd_{fd} {
+    setp(buffer_, buffer_ + sizeof buffer_);
+  }
+  ~FileDescriptorBuffer() { sync(); }
+
+protected:
+  int_type overflow(int_type ch) override {
+    if (sync() != 0) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+  int sync() override {
+    bool ok{WriteFully(fd_, pbase(), pptr() - pbase())};
+    setp(buffer_, buffer_ + sizeof buffer_);
+    return ok ? 0 : -1;
+  }
+
+private:
+  int fd_;
+  char buffer_[64 * 1024];
+};
+
+// Runs the backend compiler on the unparsed source that unparse() writes
+// to a stream, and returns the name of the relocatable.
+template<typename UNPARSE>
+std::string CompileUnparsedSource(
+    const std::string &path, DriverOptions &driver, const UNPARSE &unparse) {
+  std::string relo{RelocatableName(driver, path)};
+  if (driver.pipeToCompiler.value_or(false)) {
+    // The compiler reads the unparsed source from a pipe while it is
+    // being produced; nothing is written to the file system.
+    int fds[2];
+    if (pipe(fds) != 0) {
+      std::cerr << driver.prefix << "pipe failed: " << std::strerror(errno)
+                << '\n';
+      exit(EXIT_FAILURE);
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid{fork()};
+    if (pid == 0) {
+      dup2(fds[0], 0);
+      close(fds[0]);
+      close(fds[1]);
+      signal(SIGPIPE, SIG_DFL);
+      RunOtherCompilerOnStandardInput(driver, relo.data());
+    }
+    close(fds[0]);
+    if (pid < 0) {
+      std::cerr << driver.prefix << "fork failed: " << std::strerror(errno)
+                << '\n';
+      exit(EXIT_FAILURE);
+    }
+    {
+      // If the compiler quits early, writes fail with EPIPE.
+      auto oldHandler{signal(SIGPIPE, SIG_IGN)};
+      FileDescriptorBuffer buffer{fds[1]};
+      std::ostream pipeStream{&buffer};
+      unparse(pipeStream);
+      pipeStream.flush();
+      signal(SIGPIPE, oldHandler);
+    }
+    close(fds[1]);
+    int childStat{0};
+    waitpid(pid, &childStat, 0);
+    if (!WIFEXITED(childStat) || WEXITSTATUS(childStat) != 0) {
+      exit(EXIT_FAILURE);
+    }
+    if (!driver.compileOnly && driver.outputPath.empty()) {
+      filesToDelete.push_back(relo);
+    }
+    return relo;
+  }
+
+  // The compiler can't read a pipe; write the source to a unique file.
+  char tmpSourcePath[]{"/tmp/f18-XXXXXX.f90"};
+  int fd{mkstemps(tmpSourcePath, 4)};
+  if (fd < 0) {
+    std::cerr << driver.prefix << "could not create temporary file: "
+              << std::strerror(errno) << '\n';
+    exit(EXIT_FAILURE);
+  }
+  filesToDelete.push_back(tmpSourcePath);
+  {
+    FileDescriptorBuffer buffer{fd};
+    std::ostream tmpSource{&buffer};
+    unparse(tmpSource);
+  }
+  close(fd);
+
+  if (ParentProcess()) {
+    if (!driver.compileOnly && driver.outputPath.empty()) {
+      filesToDelete.push_back(relo);
+    }
+    return relo;
+  }
+  RunOtherCompiler(driver, tmpSourcePath, relo.data());
+  return {};
+}
+
+// The options that must agree between a compile server and a client
+// for the client to use the server's resident modules
+std::string Configuration(const DriverOptions &driver,
+    const Fortran::parser::Options &options,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  std::stringstream result;
+  std::vector<char> cwd(4096);
+  if (getcwd(cwd.data(), cwd.size()) != nullptr) {
+    result << cwd.data();
+  }
+  result << '\n' << driver.moduleFileSuffix << '\n';
+  for (const auto &dir : driver.searchDirectories) {
+    result << dir << '\n';
+  }
+  result << static_cast<int>(driver.encoding);
+  for (auto category : {Fortran::common::TypeCategory::Integer,
+           Fortran::common::TypeCategory::Real,
+           Fortran::common::TypeCategory::Character,
+           Fortran::common::TypeCategory::Logical}) {
+    result << ',' << defaultKinds.GetDefaultKind(category);
+  }
+  result << ',' << defaultKinds.doublePrecisionKind() << ','
+         << defaultKinds.quadPrecisionKind() << '\n';
+  for (std::size_t j{0}; j < Fortran::parser::LanguageFeature_enumSize; ++j) {
+    auto feature{static_cast<Fortran::parser::LanguageFeature>(j)};
+    result << options.features.IsEnabled(feature)
+           << options.features.ShouldWarn(feature);
+  }
+  return result.str();
+}
+
+// A cache of front end results (-fcache-dir=dir, or F18_CACHE_DIR).  An
+// entry is named by a hash of the source path, the cooked character stream,
+// and the options that affect the front end.  It remains valid for as long
+// as the module files that the compilation read keep the same checksums.
+// It holds the standard output and error of the front end, the module
+// files that it wrote, and the unparsed source that was passed to the
+// backend compiler, if any.  Failed compilations are not cached: a failure
+// can be due to a module file that was not found, and nothing would
+// notice when that module file appears.
+struct FrontEndResult {
+  std::map<std::string, std::string> moduleFilesRead;  // path -> checksum
+  std::map<std::string, std::string> moduleFilesWritten;  // path -> text
+  std::string out, err;
+  std::optional<std::string> unparsed;
+};
+
+static constexpr const char *frontEndCacheMagic{"f18 front end cache v2"};
+
+// 64-bit FNV-1a
+std::uint64_t HashBytes(const std::string &bytes, std::uint64_t hash) {
+  for (char ch : bytes) {
+    hash ^= static_cast<unsigned char>(ch);
+    hash *= 0x100000001b3u;
+  }
+  return hash;
+}
+
+std::string FrontEndCacheEntry(const std::string &path,
+    const std::string &cooked, const DriverOptions &driver,
+    const Fortran::parser::Options &options,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  std::stringstream key;
+  key << frontEndCacheMagic << '\n'
+      << path << '\n'
+      << driver.prefix << '\n'
+      << driver.moduleDirectory << '\n'
+      << Configuration(driver, options, defaultKinds) << '\n'
+      << driver.warningsAreErrors << driver.parseOnly << driver.dumpUnparse
+      << driver.dumpUnparseWithSymbols << driver.dumpParseTree
+      << driver.dumpSymbols << driver.debugResolveNames
+      << driver.debugSemantics << driver.measureTree
+      << driver.unparseTypedExprsToPGF90 << options.instrumentedParse << '\n';
+  std::uint64_t hash{HashBytes(key.str(), 0xcbf29ce484222325u)};
+  hash = HashBytes(cooked, hash);
+  char name[17];
+  std::snprintf(name, sizeof name, "%016llx",
+      static_cast<unsigned long long>(hash));
+  return driver.cacheDirectory + '/' + name;
+}
+
+void PutCacheRecord(std::ostream &o, const char *tag, const std::string &name,
+    const std::string &data) {
+  o << tag << ' ' << data.size() << ' ' << name << '\n' << data << '\n';
+}
+
+std::optional<FrontEndResult> LoadFrontEndResult(const std::string &entry) {
+  std::ifstream in{entry, std::ios::binary};
+  std::string line;
+  if (!std::getline(in, line) || line != frontEndCacheMagic) {
+    return std::nullopt;
+  }
+  FrontEndResult result;
+  std::string tag, name, data;
+  std::size_t bytes;
+  while (in >> tag >> bytes) {
+    in.get();
+    std::getline(in, name);
+    data.resize(bytes);
+    if (!in.read(data.data(), bytes) || in.get() != '\n') {
+      return std::nullopt;
+    }
+    if (tag == "read") {
+      result.moduleFilesRead[name] = data;
+    } else if (tag == "wrote") {
+      result.moduleFilesWritten[name] = data;
+    } else if (tag == "out") {
+      result.out = data;
+    } else if (tag == "err") {
+      result.err = data;
+    } else if (tag == "unparsed") {
+      result.unparsed = data;
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (!in.eof()) {
+    return std::nullopt;
+  }
+  for (const auto &pair : result.moduleFilesRead) {
+    if (Fortran::semantics::GetModFileChecksum(pair.first) != pair.second) {
+      return std::nullopt;  // stale
+    }
+  }
+  return result;
+}
+
+void SaveFrontEndResult(const std::string &entry, const FrontEndResult &result,
+    const DriverOptions &driver) {
+  mkdir(driver.cacheDirectory.c_str(), 0777);
+  std::string temp{entry + '.' + std::to_string(getpid())};
+  {
+    std::ofstream out{temp, std::ios::binary};
+    out << frontEndCacheMagic << '\n';
+    for (const auto &pair : result.moduleFilesRead) {
+      PutCacheRecord(out, "read", pair.first, pair.second);
+    }
+    for (const auto &pair : result.moduleFilesWritten) {
+      PutCacheRecord(out, "wrote", pair.first, pair.second);
+    }
+    PutCacheRecord(out, "out", "", result.out);
+    PutCacheRecord(out, "err", "", result.err);
+    if (result.unparsed.has_value()) {
+      PutCacheRecord(out, "unparsed", "", *result.unparsed);
+    }
+    if (!out.flush()) {
+      out.close();
+      unlink(temp.c_str());
+      return;
+    }
+  }
+  if (rename(temp.c_str(), entry.c_str()) != 0) {
+    unlink(temp.c_str());
+  }
+}
+
+std::string ReadWholeFile(const std::string &path) {
+  std::ifstream in{path, std::ios::binary};
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+// Diverts standard output and error while the front end runs on a cache
+// miss, so that they can be recorded in the cache, and then records the
+// rest of the result.  Early returns from CompileFortran record results
+// without unparsed source.
+class FrontEndRecorder {
+public:
+  FrontEndRecorder(std::string entry, const DriverOptions &driver)
+    : entry_{std::move(entry)}, driver_{driver},
+      oldOut_{std::cout.rdbuf(out_.rdbuf())},
+      oldErr_{std::cerr.rdbuf(err_.rdbuf())} {}
+  ~FrontEndRecorder() { Finish(); }
+
+  void set_context(const Fortran::semantics::SemanticsContext &context) {
+    context_ = &context;
+  }
+
+  void Finish(const std::string *unparsed = nullptr) {
+    if (finished_) {
+      return;
+    }
+    finished_ = true;
+    std::cout.rdbuf(oldOut_);
+    std::cerr.rdbuf(oldErr_);
+    FrontEndResult result;
+    result.out = out_.str();
+    result.err = err_.str();
+    std::cout << result.out;
+    std::cerr << result.err;
+    if (exitStatusBefore_ != EXIT_SUCCESS || exitStatus != EXIT_SUCCESS) {
+      return;  // this compilation failed, or can't tell whether it did
+    }
+    if (context_ != nullptr) {
+      result.moduleFilesRead = context_->moduleFilesRead();
+      for (const std::string &path : context_->moduleFilesWritten()) {
+        result.moduleFilesWritten[path] = ReadWholeFile(path);
+      }
+    }
+    if (unparsed != nullptr) {
+      result.unparsed = *unparsed;
+    }
+    SaveFrontEndResult(entry_, result, driver_);
+  }
+
+private:
+  std::string entry_;
+  const DriverOptions &driver_;
+  const Fortran::semantics::SemanticsContext *context_{nullptr};
+  int exitStatusBefore_{exitStatus};
+  std::stringstream out_, err_;
+  std::streambuf *oldOut_, *oldErr_;
+  bool finished_{false};
+};
+
+// Reproduces the effects of a cached compilation.
+std::string UseFrontEndResult(const FrontEndResult &result,
+    const std::string &path, DriverOptions &driver) {
+  if (driver.verbose) {
+    std::cerr << driver.prefix << "using cached front end result for "
+              << path << '\n';
+  }
+  std::cout << result.out;
+  std::cerr << result.err;
+  for (const auto &pair : result.moduleFilesWritten) {
+    // Like ModFileWriter, leave a module file alone if it is unchanged.
+    if (ReadWholeFile(pair.first) != pair.second) {
+      std::ofstream out{pair.first, std::ios::binary};
+      if (!(out << pair.second)) {
+        std::cerr << driver.prefix << "could not write " << pair.first
+                  << '\n';
+        exitStatus = EXIT_FAILURE;
+      }
+    }
+  }
+  if (!result.unparsed.has_value()) {
+    return {};
+  }
+  return CompileUnparsedSource(
+      path, driver, [&](std::ostream &o) { o << *result.unparsed; });
+}
+
+// A prescanned source file.  The module dependence scan (-fmodule-order)
+// keeps the sources that it prescans for their compilations, unless there
+// is a resident context, whose AllSources the compilations must use.
+struct PrescannedSource {
+  std::unique_ptr<Fortran::parser::AllSources> allSources;
+  std::unique_ptr<Fortran::parser::Parsing> parsing;
+};
+std::map<std::string, PrescannedSource> prescannedSources;
+
+PrescannedSource Prescan(const std::string &path,
+    const Fortran::parser::Options &options, const DriverOptions &driver,
+    Fortran::parser::AllSources *residentSources) {
+  Fortran::common::PhaseReport *report{
+      driver.timeReport || driver.memoryReport ? &phaseReport : nullptr};
+  PrescannedSource result{std::make_unique<Fortran::parser::AllSources>()};
+  result.allSources->set_encoding(driver.encoding);
+  result.parsing = std::make_unique<Fortran::parser::Parsing>(
+      residentSources ? *residentSources : *result.allSources);
+  Fortran::common::PhaseReport::Measure(
+      report, "Prescan", [&]() { result.parsing->Prescan(path, options); });
+  return result;
+}
+
+std::string CompileFortran(std::string path, Fortran::parser::Options options,
+    DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  Fortran::common::PhaseReport *report{
+      driver.timeReport || driver.memoryReport ? &phaseReport : nullptr};
+  SetSourceOptions(path, options, driver);
+  PrescannedSource source;
+  if (auto iter{prescannedSources.find(path)};
+      iter != prescannedSources.end() && residentContext == nullptr) {
+    source = std::move(iter->second);
+    prescannedSources.erase(iter);
+  } else {
+    source = Prescan(path, options, driver,
+        residentContext ? &residentContext->allSources() : nullptr);
+  }
+  Fortran::parser::AllSources &allSources{*source.allSources};
+  Fortran::parser::Parsing &parsing{*source.parsing};
   if (!parsing.messages().empty() &&
       (driver.warningsAreErrors || parsing.messages().AnyFatalError())) {
     std::cerr << driver.prefix << "could not scan " << path << '\n';
@@ -200,12 +779,43 @@ std::string CompileFortran(std::string path, Fortran::parser::Options options,
     parsing.DumpCookedChars(std::cout);
     return {};
   }
-  parsing.Parse(&std::cout);
+  std::optional<Fortran::semantics::SemanticsContext> ownContext;
+  std::optional<FrontEndRecorder> recorder;  // destroyed before ownContext
+  if (!driver.cacheDirectory.empty()) {
+    std::string entry{FrontEndCacheEntry(
+        path, parsing.cooked().data(), driver, options, defaultKinds)};
+    if (auto cached{LoadFrontEndResult(entry)}) {
+      return UseFrontEndResult(*cached, path, driver);
+    }
+    recorder.emplace(std::move(entry), driver);
+  }
+  if (residentContext == nullptr) {
+    ownContext.emplace(defaultKinds, options.features, allSources);
+  }
+  Fortran::semantics::SemanticsContext &semanticsContext{
+      residentContext ? *residentContext : *ownContext};
+  semanticsContext.set_moduleDirectory(driver.moduleDirectory)
+      .set_moduleFileSuffix(driver.moduleFileSuffix)
+      .set_searchDirectories(driver.searchDirectories)
+      .set_warnOnNonstandardUsage(driver.warnOnNonstandardUsage)
+      .set_warningsAreErrors(driver.warningsAreErrors)
+      .set_phaseReport(report);
+  if (recorder.has_value()) {
+    recorder->set_context(semanticsContext);
+  }
+  std::size_t liveBytesBeforeParse{
+      Fortran::common::allocationCounts.liveBytes};
+  Fortran::common::PhaseReport::Measure(
+      report, "Parse", [&]() { parsing.Parse(&std::cout); });
   if (options.instrumentedParse) {
     parsing.DumpParsingLog(std::cout);
     return {};
   }
   parsing.ClearLog();
+  std::size_t parseTreeBytes{
+      Fortran::common::allocationCounts.liveBytes > liveBytesBeforeParse
+          ? Fortran::common::allocationCounts.liveBytes - liveBytesBeforeParse
+          : 0};
   parsing.messages().Emit(std::cerr, parsing.cooked());
   if (!parsing.consumedWholeFile()) {
     parsing.EmitMessage(
@@ -222,14 +832,27 @@ std::string CompileFortran(std::string path, Fortran::parser::Options options,
   }
   auto &parseTree{*parsing.parseTree()};
   if (driver.measureTree) {
-    MeasureParseTree(parseTree);
+    MeasureParseTree(parseTree, parseTreeBytes);
+  }
+  if (driver.memoryReport) {
+    MeasureDataStructures(phaseReport, parsing, parseTreeBytes, nullptr);
   }
   // TODO: Change this predicate to just "if (!driver.debugNoSemantics)"
   if (driver.debugSemantics || driver.debugResolveNames || driver.dumpSymbols ||
       driver.dumpUnparseWithSymbols) {
+    if (residentContext != nullptr) {
+      ForgetResidentModules(parseTree);
+    }
     Fortran::semantics::Semantics semantics{
         semanticsContext, parseTree, parsing.cooked()};
     semantics.Perform();
+    if (driver.memoryReport) {
+      MeasureDataStructures(
+          phaseReport, parsing, parseTreeBytes, &semanticsContext);
+    }
+    if (moduleReportFd >= 0) {
+      ReportModulesRead(semanticsContext);
+    }
     semantics.EmitMessages(std::cerr);
     if (driver.dumpSymbols) {
       semantics.DumpSymbols(std::cout);
@@ -272,32 +895,26 @@ std::string CompileFortran(std::string path, Fortran::parser::Options options,
     return {};
   }
 
-  std::string relo{RelocatableName(driver, path)};
-
-  char tmpSourcePath[32];
-  std::snprintf(tmpSourcePath, sizeof tmpSourcePath, "/tmp/f18-%lx.f90",
-      static_cast<unsigned long>(getpid()));
-  {
-    std::ofstream tmpSource;
-    tmpSource.open(tmpSourcePath);
+  auto unparseForCompiler{[&](std::ostream &o) {
+    Fortran::common::PhaseReport::Timer timer{report, "Unparse"};
     Fortran::evaluate::formatForPGF90 = true;
-    Unparse(tmpSource, parseTree, driver.encoding, true /*capitalize*/,
+    Unparse(o, parseTree, driver.encoding, true /*capitalize*/,
         options.features.IsEnabled(
             Fortran::parser::LanguageFeature::BackslashEscapes),
         nullptr /* action before each statement */,
         driver.unparseTypedExprsToPGF90 ? &unparseExpression : nullptr);
     Fortran::evaluate::formatForPGF90 = false;
-  }
+  }};
 
-  if (ParentProcess()) {
-    filesToDelete.push_back(tmpSourcePath);
-    if (!driver.compileOnly && driver.outputPath.empty()) {
-      filesToDelete.push_back(relo);
-    }
-    return relo;
+  if (recorder.has_value()) {
+    std::stringstream unparsed;
+    unparseForCompiler(unparsed);
+    std::string source{unparsed.str()};
+    recorder->Finish(&source);
+    return CompileUnparsedSource(
+        path, driver, [&](std::ostream &o) { o << source; });
   }
-  RunOtherCompiler(driver, tmpSourcePath, relo.data());
-  return {};
+  return CompileUnparsedSource(path, driver, unparseForCompiler);
 }
 
 std::string CompileOtherLanguage(std::string path, DriverOptions &driver) {
@@ -312,6 +929,840 @@ std::string CompileOtherLanguage(std::string path, DriverOptions &driver) {
   return {};
 }
 
+// A resident semantics context, of a compile server or of a batch of
+// compilations, and the modules loaded into it
+struct ResidentModules {
+  std::unique_ptr<Fortran::parser::AllSources> allSources;
+  std::unique_ptr<Fortran::semantics::SemanticsContext> context;
+  std::set<std::string> loaded, unloadable;
+  std::set<std::string> reported;  // read by compilations, not yet loaded
+  std::list<std::string> names;  // referenced by SourceNames
+};
+
+void MakeResidentContext(ResidentModules &resident,
+    const Fortran::parser::Options &options, const DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  resident.context.reset();
+  resident.allSources = std::make_unique<Fortran::parser::AllSources>();
+  resident.allSources->set_encoding(driver.encoding);
+  resident.context = std::make_unique<Fortran::semantics::SemanticsContext>(
+      defaultKinds, options.features, *resident.allSources);
+  resident.context->set_moduleDirectory(driver.moduleDirectory)
+      .set_moduleFileSuffix(driver.moduleFileSuffix)
+      .set_searchDirectories(driver.searchDirectories);
+}
+
+// Loads some modules into the resident context.  A module whose module
+// file has errors would poison the resident context, so in that case the
+// context is rebuilt without it.
+void LoadResidentModules(ResidentModules &resident,
+    const std::set<std::string> &names, const Fortran::parser::Options &options,
+    const DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  for (const std::string &name : names) {
+    if (resident.loaded.count(name) > 0 ||
+        resident.unloadable.count(name) > 0) {
+      continue;
+    }
+    resident.names.push_back(name);
+    Fortran::semantics::SourceName sourceName{resident.names.back()};
+    Fortran::semantics::ModFileReader{*resident.context}.Read(sourceName);
+    if (resident.context->messages().empty()) {
+      resident.loaded.insert(name);
+    } else {
+      resident.unloadable.insert(name);
+      std::set<std::string> reload;
+      reload.swap(resident.loaded);
+      MakeResidentContext(resident, options, driver, defaultKinds);
+      LoadResidentModules(resident, reload, options, driver, defaultKinds);
+      return;
+    }
+  }
+}
+
+// Starts afresh when any module file behind the resident modules has changed.
+void CheckResidentModules(ResidentModules &resident,
+    const Fortran::parser::Options &options, const DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  for (const auto &pair : resident.context->moduleFilesRead()) {
+    if (Fortran::semantics::GetModFileChecksum(pair.first) != pair.second) {
+      if (driver.verbose) {
+        std::cerr << driver.prefix << pair.first << " has changed\n";
+      }
+      std::set<std::string> reload;
+      reload.swap(resident.loaded);
+      resident.unloadable.clear();
+      MakeResidentContext(resident, options, driver, defaultKinds);
+      LoadResidentModules(resident, reload, options, driver, defaultKinds);
+      return;
+    }
+  }
+}
+
+// The intrinsic modules, loaded at the start of a batch when their module
+// files can be found
+static constexpr const char *intrinsicModules[]{"iso_c_binding",
+    "iso_fortran_env", "ieee_arithmetic", "ieee_exceptions", "ieee_features"};
+
+bool HasModuleFile(const std::string &name, const DriverOptions &driver) {
+  for (const std::string &dir : driver.searchDirectories) {
+    std::string path{dir + '/' + name + driver.moduleFileSuffix};
+    if (access(path.c_str(), R_OK) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// In batch mode (-fbatch), the driver's own resident modules.  Each
+// compilation runs in a child process that starts with a copy of them,
+// so nothing needs to be reset between compilations, and the modules that
+// one compilation reads are loaded for the compilations that follow.
+ResidentModules *batchModules{nullptr};
+
+void UpdateBatchModules(const Fortran::parser::Options &options,
+    const DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  CheckResidentModules(*batchModules, options, driver, defaultKinds);
+  std::set<std::string> names;
+  names.swap(batchModules->reported);
+  LoadResidentModules(*batchModules, names, options, driver, defaultKinds);
+  residentContext = batchModules->context.get();
+}
+
+// A compilation of one Fortran source file in a child process (-j N)
+struct CompilationJob {
+  std::string path;
+  pid_t pid{-1};
+  std::FILE *out{nullptr}, *err{nullptr}, *relo{nullptr};
+  std::FILE *report{nullptr};  // the child's serialized PhaseReport
+  std::FILE *modules{nullptr};  // names of modules read, under -fbatch
+  int status{0};
+  bool done{false};
+};
+
+void StartCompilationJob(CompilationJob &job,
+    const Fortran::parser::Options &options, DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  job.out = std::tmpfile();
+  job.err = std::tmpfile();
+  job.relo = std::tmpfile();
+  job.report = std::tmpfile();
+  if (batchModules != nullptr) {
+    job.modules = std::tmpfile();
+  }
+  if (job.out == nullptr || job.err == nullptr || job.relo == nullptr ||
+      job.report == nullptr ||
+      (batchModules != nullptr && job.modules == nullptr)) {
+    std::cerr << driver.prefix << "could not create temporary file: "
+              << std::strerror(errno) << '\n';
+    exit(EXIT_FAILURE);
+  }
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+  job.pid = fork();
+  if (job.pid < 0) {
+    std::cerr << driver.prefix << "fork failed: " << std::strerror(errno)
+              << '\n';
+    exit(EXIT_FAILURE);
+  }
+  if (job.pid == 0) {
+    dup2(fileno(job.out), 1);
+    dup2(fileno(job.err), 2);
+    filesToDelete.clear();  // they belong to the parent
+    phaseReport = Fortran::common::PhaseReport{};
+    if (job.modules != nullptr) {
+      moduleReportFd = fileno(job.modules);
+    }
+    std::string relo{CompileFortran(job.path, options, driver, defaultKinds)};
+    // The parent now owns the relocatable; don't delete it at exit here.
+    filesToDelete.erase(
+        std::remove(filesToDelete.begin(), filesToDelete.end(), relo),
+        filesToDelete.end());
+    std::fputs(relo.c_str(), job.relo);
+    std::fputs(phaseReport.Serialize().c_str(), job.report);
+    std::cout.flush();
+    std::cerr.flush();
+    exit(exitStatus);
+  }
+  prescannedSources.erase(job.path);  // the child has its own copy
+}
+
+void ReplayCapturedOutput(std::FILE *from, std::ostream &to) {
+  std::rewind(from);
+  char buffer[4096];
+  while (std::size_t got{std::fread(buffer, 1, sizeof buffer, from)}) {
+    to.write(buffer, got);
+  }
+  to.flush();
+}
+
+std::string ReadCapturedOutput(std::FILE *from) {
+  std::ostringstream ss;
+  ReplayCapturedOutput(from, ss);
+  return ss.str();
+}
+
+std::string FinishCompilationJob(CompilationJob &job, DriverOptions &driver) {
+  ReplayCapturedOutput(job.out, std::cout);
+  ReplayCapturedOutput(job.err, std::cerr);
+  phaseReport.Deserialize(ReadCapturedOutput(job.report));
+  std::string relo;
+  if (WIFEXITED(job.status) && WEXITSTATUS(job.status) == EXIT_SUCCESS) {
+    relo = ReadCapturedOutput(job.relo);
+  } else {
+    if (WIFSIGNALED(job.status)) {
+      std::cerr << driver.prefix << "compilation of " << job.path
+                << " terminated by signal " << WTERMSIG(job.status) << '\n';
+    }
+    exitStatus = EXIT_FAILURE;
+  }
+  std::fclose(job.out);
+  std::fclose(job.err);
+  std::fclose(job.relo);
+  std::fclose(job.report);
+  if (job.modules != nullptr) {
+    std::stringstream lines{ReadCapturedOutput(job.modules)};
+    for (std::string name; std::getline(lines, name);) {
+      batchModules->reported.insert(name);
+    }
+    std::fclose(job.modules);
+  }
+  if (!relo.empty() && !driver.compileOnly && driver.outputPath.empty()) {
+    filesToDelete.push_back(relo);
+  }
+  return relo;
+}
+
+// Compiles several Fortran source files concurrently, each in its own
+// child process, with at most driver.jobs children running at once.
+// The standard output and error of each child are captured in anonymous
+// temporary files and replayed in the order of the source files so that
+// messages appear just as they would from a sequential compilation.
+// The result has one entry per source, in order; an entry is empty when
+// that compilation produced no relocatable.
+std::vector<std::string> CompileFortranInParallel(
+    const std::vector<std::string> &paths,
+    const Fortran::parser::Options &options, DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  std::vector<CompilationJob> jobs(paths.size());
+  for (std::size_t j{0}; j < paths.size(); ++j) {
+    jobs[j].path = paths[j];
+  }
+  std::vector<std::string> result;
+  std::size_t next{0}, running{0};
+  while (result.size() < jobs.size()) {
+    for (; running < static_cast<std::size_t>(driver.jobs) &&
+         next < jobs.size();
+         ++next, ++running) {
+      if (batchModules != nullptr) {
+        UpdateBatchModules(options, driver, defaultKinds);
+      }
+      StartCompilationJob(jobs[next], options, driver, defaultKinds);
+    }
+    int childStat{0};
+    pid_t pid{wait(&childStat)};
+    if (pid < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << driver.prefix << "wait failed: " << std::strerror(errno)
+                << '\n';
+      exit(EXIT_FAILURE);
+    }
+    for (std::size_t j{result.size()}; j < next; ++j) {
+      if (jobs[j].pid == pid) {
+        jobs[j].status = childStat;
+        jobs[j].done = true;
+        --running;
+        break;
+      }
+    }
+    while (result.size() < next && jobs[result.size()].done) {
+      result.push_back(FinishCompilationJob(jobs[result.size()], driver));
+    }
+  }
+  return result;
+}
+
+std::vector<std::string> CompileFortranSources(
+    const std::vector<std::string> &paths,
+    const Fortran::parser::Options &options, DriverOptions &driver,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  // Under a compile server, each compilation must begin with a pristine
+  // copy of the resident context, so each gets its own child process.
+  if (paths.size() > 1 && (driver.jobs > 1 || residentContext != nullptr)) {
+    return CompileFortranInParallel(paths, options, driver, defaultKinds);
+  }
+  std::vector<std::string> result;
+  for (const auto &path : paths) {
+    result.emplace_back(CompileFortran(path, options, driver, defaultKinds));
+  }
+  return result;
+}
+
+// The modules and submodules that a Fortran source file defines, and
+// those that it needs, as found by a quick scan of its cooked character
+// stream.  Submodules are named "ancestor:submodule".
+struct ModuleDependences {
+  std::vector<std::string> defines, uses;
+};
+
+// Breaks one cooked statement into lower-case names and single punctuation
+// characters, skipping blanks and character literals.
+std::vector<std::string> StatementTokens(const char *p, const char *end) {
+  std::vector<std::string> tokens;
+  while (p < end) {
+    if (*p == ' ') {
+      ++p;
+    } else if (*p == '\'' || *p == '"') {
+      char quote{*p++};
+      while (p < end && *p++ != quote) {
+      }
+    } else if (Fortran::parser::IsLegalInIdentifier(*p)) {
+      const char *start{p};
+      while (p < end && Fortran::parser::IsLegalInIdentifier(*p)) {
+        ++p;
+      }
+      tokens.emplace_back(start, p - start);
+    } else {
+      tokens.emplace_back(1, *p++);
+    }
+  }
+  return tokens;
+}
+
+// Recognizes MODULE, SUBMODULE, and USE statements well enough for build
+// ordering without parsing.  Blanks are insignificant in fixed form, so
+// keywords may be fused with the names that follow them.
+void ClassifyStatement(
+    const std::vector<std::string> &tokens, ModuleDependences &result) {
+  std::size_t n{tokens.size()}, j{0};
+  if (n > 0 && Fortran::parser::IsDecimalDigit(tokens[0][0])) {
+    ++j;  // statement label
+  }
+  if (j >= n) {
+    return;
+  }
+  const std::string &first{tokens[j]};
+  if (first.compare(0, 6, "module") == 0) {
+    if (first == "module" && j + 2 == n) {
+      result.defines.push_back(tokens[j + 1]);
+    } else if (first.size() > 6 && j + 1 == n &&
+        first.compare(6, 9, "procedure") != 0) {
+      result.defines.push_back(first.substr(6));
+    }
+  } else if (first == "submodule") {
+    // SUBMODULE ( ancestor [: parent] ) name
+    if (j + 5 <= n && tokens[j + 1] == "(") {
+      const std::string &ancestor{tokens[j + 2]};
+      std::size_t k{j + 3};
+      if (k + 1 < n && tokens[k] == ":") {
+        result.uses.push_back(ancestor + ':' + tokens[k + 1]);
+        k += 2;
+      } else {
+        result.uses.push_back(ancestor);
+      }
+      if (k + 2 == n && tokens[k] == ")") {
+        result.defines.push_back(ancestor + ':' + tokens[k + 1]);
+      }
+    }
+  } else if (first.compare(0, 3, "use") == 0) {
+    // USE [[, module-nature] ::] name [, ...]
+    std::size_t k{j + 1};
+    std::string name;
+    if (first != "use") {
+      name = first.substr(3);
+    } else if (k < n && tokens[k] == ",") {
+      if (k + 3 < n && tokens[k + 1] == "non_intrinsic" &&
+          tokens[k + 2] == ":" && tokens[k + 3] == ":") {
+        k += 4;
+      } else {
+        return;  // INTRINSIC modules are not built from sources
+      }
+    } else if (k + 1 < n && tokens[k] == ":" && tokens[k + 1] == ":") {
+      k += 2;
+    }
+    if (name.empty()) {
+      if (k >= n || !Fortran::parser::IsLetter(tokens[k][0])) {
+        return;
+      }
+      name = tokens[k++];
+    }
+    if (k == n || tokens[k] == ",") {
+      result.uses.push_back(name);
+    }
+  }
+}
+
+// Prescans a source file, without parsing it, and classifies the
+// statements of its cooked character stream.  The prescanned source is
+// kept for the file's compilation.
+ModuleDependences ScanModuleDependences(const std::string &path,
+    Fortran::parser::Options options, const DriverOptions &driver) {
+  SetSourceOptions(path, options, driver);
+  PrescannedSource source{Prescan(path, options, driver, nullptr)};
+  ModuleDependences result;
+  const std::string &cooked{source.parsing->cooked().data()};
+  const char *p{cooked.data()}, *end{p + cooked.size()};
+  while (p < end) {
+    const char *stmtEnd{p};
+    for (char quote{'\0'}; stmtEnd < end && *stmtEnd != '\n'; ++stmtEnd) {
+      if (quote != '\0') {
+        if (*stmtEnd == quote) {
+          quote = '\0';
+        }
+      } else if (*stmtEnd == '\'' || *stmtEnd == '"') {
+        quote = *stmtEnd;
+      } else if (*stmtEnd == ';' || *stmtEnd == '!') {
+        break;
+      }
+    }
+    if (*p != '!') {
+      ClassifyStatement(StatementTokens(p, stmtEnd), result);
+    }
+    p = stmtEnd;
+    if (p < end && *p == '!') {
+      while (p < end && *p != '\n') {
+        ++p;
+      }
+    }
+    if (p < end) {
+      ++p;
+    }
+  }
+  if (residentContext == nullptr) {
+    prescannedSources.emplace(path, std::move(source));
+  }
+  return result;
+}
+
+// Partitions the Fortran sources into waves such that every source that
+// defines a module (or submodule ancestor) needed by another source lies in
+// an earlier wave; the sources in a wave are independent of each other and
+// can be compiled concurrently.  Sources involved in a cycle go last.
+// Without -fmodule-order, as under -j N alone, the sources are taken to be
+// in a workable order already: only a source that defines a module needed
+// by a later source must precede it, and nothing is reordered otherwise.
+// Standard input ("-") can be read only once, so it is not scanned; it is
+// compiled by itself after all of the other sources.
+std::vector<std::vector<std::size_t>> ScheduleByModuleDependences(
+    const std::vector<std::string> &paths,
+    const Fortran::parser::Options &options, const DriverOptions &driver) {
+  std::size_t n{paths.size()};
+  std::vector<ModuleDependences> scanned(n);
+  std::map<std::string, std::size_t> definer;
+  std::vector<bool> scheduled(n, false);
+  std::vector<std::size_t> standardInput;
+  for (std::size_t j{0}; j < n; ++j) {
+    if (paths[j] == "-") {
+      scheduled[j] = true;
+      standardInput.push_back(j);
+      continue;
+    }
+    scanned[j] = ScanModuleDependences(paths[j], options, driver);
+    for (const std::string &name : scanned[j].defines) {
+      definer.emplace(name, j);
+    }
+  }
+  std::vector<std::set<std::size_t>> dependents(n);
+  std::vector<std::size_t> unmet(n, 0);
+  for (std::size_t j{0}; j < n; ++j) {
+    for (const std::string &name : scanned[j].uses) {
+      auto iter{definer.find(name)};
+      if (iter != definer.end() && iter->second != j &&
+          (driver.moduleOrder || iter->second < j) &&
+          dependents[iter->second].insert(j).second) {
+        ++unmet[j];
+      }
+    }
+  }
+  std::vector<std::vector<std::size_t>> waves;
+  std::size_t count{standardInput.size()};
+  while (count < n) {
+    std::vector<std::size_t> wave;
+    for (std::size_t j{0}; j < n; ++j) {
+      if (!scheduled[j] && unmet[j] == 0) {
+        wave.push_back(j);
+      }
+    }
+    if (wave.empty()) {
+      std::cerr << driver.prefix << "cyclic module dependences among:";
+      for (std::size_t j{0}; j < n; ++j) {
+        if (!scheduled[j]) {
+          std::cerr << ' ' << paths[j];
+          wave.push_back(j);
+        }
+      }
+      std::cerr << '\n';
+    }
+    for (std::size_t j : wave) {
+      scheduled[j] = true;
+      for (std::size_t k : dependents[j]) {
+        --unmet[k];
+      }
+    }
+    count += wave.size();
+    waves.emplace_back(std::move(wave));
+  }
+  if (!standardInput.empty()) {
+    waves.emplace_back(std::move(standardInput));
+  }
+  if (driver.verbose) {
+    for (std::size_t w{0}; w < waves.size(); ++w) {
+      std::cerr << driver.prefix << "wave " << (w + 1) << ':';
+      for (std::size_t j : waves[w]) {
+        std::cerr << ' ' << paths[j];
+      }
+      std::cerr << '\n';
+    }
+  }
+  return waves;
+}
+
+// Compile server (--server) and client (F18_SERVER)
+//
+// A client connects to the server's Unix domain socket and sends its
+// working directory, environment, and command line, together with its
+// standard input, output, and error file descriptors.  The server forks a
+// worker process to run the command line; the worker inherits the server's
+// resident semantics context, so modules that earlier compilations read
+// from module files are already resolved.  The worker reports the modules
+// that its compilations read, which the server then loads into the resident
+// context, and finally sends its exit status back to the client.  Before
+// each request the server verifies the checksums of the module files behind
+// the resident modules and starts afresh if any have changed.
+//
+// Only the server's own user may connect: the socket is created with mode
+// 0600 and the credentials of each peer are checked.  SIGTERM, SIGINT, or
+// SIGHUP stops the server, which waits for its workers and removes its
+// socket.
+
+int RunDriver(std::list<std::string>);
+
+bool ReadFully(int fd, char *data, std::size_t bytes) {
+  while (bytes > 0) {
+    ssize_t got{read(fd, data, bytes)};
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    data += got;
+    bytes -= got;
+  }
+  return true;
+}
+
+bool MakeSocketAddress(const char *path, sockaddr_un &addr) {
+  std::memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  if (std::strlen(path) >= sizeof addr.sun_path) {
+    return false;
+  }
+  std::strcpy(addr.sun_path, path);
+  return true;
+}
+
+static constexpr int passedDescriptors{3};  // standard input, output, error
+static constexpr std::uint32_t maxRequestBytes{16 << 20};
+
+// Sends a command line to a compile server and returns its exit status,
+// or std::nullopt when no server is listening at the socket.
+std::optional<int> ForwardToServer(
+    const char *socketPath, const std::list<std::string> &args) {
+  sockaddr_un addr;
+  if (!MakeSocketAddress(socketPath, addr)) {
+    return std::nullopt;
+  }
+  int fd{socket(AF_UNIX, SOCK_STREAM, 0)};
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) != 0) {
+    close(fd);
+    return std::nullopt;
+  }
+  // The request is a sequence of NUL-terminated strings: the working
+  // directory, the number of environment variables, the environment
+  // variables, and then the arguments.
+  std::string request;
+  std::vector<char> cwd(4096);
+  if (getcwd(cwd.data(), cwd.size()) != nullptr) {
+    request += cwd.data();
+  }
+  request += '\0';
+  std::size_t envCount{0};
+  for (char **env{environ}; *env != nullptr; ++env) {
+    ++envCount;
+  }
+  request += std::to_string(envCount) + '\0';
+  for (char **env{environ}; *env != nullptr; ++env) {
+    request += *env;
+    request += '\0';
+  }
+  for (const std::string &arg : args) {
+    request += arg;
+    request += '\0';
+  }
+  if (request.size() > maxRequestBytes) {
+    close(fd);
+    return std::nullopt;  // compile locally
+  }
+  std::uint32_t requestBytes{static_cast<std::uint32_t>(request.size())};
+  iovec iov{&requestBytes, sizeof requestBytes};
+  char control[CMSG_SPACE(passedDescriptors * sizeof(int))];
+  std::memset(control, 0, sizeof control);
+  msghdr msg;
+  std::memset(&msg, 0, sizeof msg);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  cmsghdr *cmsg{CMSG_FIRSTHDR(&msg)};
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(passedDescriptors * sizeof(int));
+  int fds[passedDescriptors]{0, 1, 2};
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof fds);
+  if (sendmsg(fd, &msg, 0) != sizeof requestBytes ||
+      !WriteFully(fd, request.data(), request.size())) {
+    close(fd);
+    return std::nullopt;
+  }
+  std::int32_t status{EXIT_FAILURE};
+  if (!ReadFully(fd, reinterpret_cast<char *>(&status), sizeof status)) {
+    status = EXIT_FAILURE;  // the worker exited early
+  }
+  close(fd);
+  return status;
+}
+
+// Receives a client's request in a worker process and runs it there.  The
+// worker is forked before the request is read so that a client that stalls
+// cannot hold up the server's other clients.
+void ReceiveRequest(int connection, const ResidentModules &resident,
+    const std::string &configuration, int reportFd) {
+  std::uint32_t requestBytes{0};
+  iovec iov{&requestBytes, sizeof requestBytes};
+  char control[CMSG_SPACE(passedDescriptors * sizeof(int))];
+  msghdr msg;
+  std::memset(&msg, 0, sizeof msg);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  if (recvmsg(connection, &msg, 0) != sizeof requestBytes) {
+    exit(EXIT_FAILURE);
+  }
+  cmsghdr *cmsg{CMSG_FIRSTHDR(&msg)};
+  if (cmsg == nullptr || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(passedDescriptors * sizeof(int))) {
+    exit(EXIT_FAILURE);
+  }
+  int fds[passedDescriptors];
+  std::memcpy(fds, CMSG_DATA(cmsg), sizeof fds);
+  if (requestBytes > maxRequestBytes) {
+    exit(EXIT_FAILURE);
+  }
+  std::string request(requestBytes, '\0');
+  if (!ReadFully(connection, request.data(), request.size())) {
+    exit(EXIT_FAILURE);
+  }
+  for (int j{0}; j < passedDescriptors; ++j) {
+    dup2(fds[j], j);
+    close(fds[j]);
+  }
+  std::vector<std::string> strings;
+  for (std::size_t at{0}; at < request.size();) {
+    std::size_t nul{request.find('\0', at)};
+    if (nul == std::string::npos) {
+      exit(EXIT_FAILURE);  // the last string is unterminated
+    }
+    strings.push_back(request.substr(at, nul - at));
+    at = nul + 1;
+  }
+  if (strings.size() < 3 || chdir(strings[0].data()) != 0) {
+    exit(EXIT_FAILURE);
+  }
+  char *countEnd{nullptr};
+  errno = 0;
+  unsigned long envCount{strtoul(strings[1].data(), &countEnd, 10)};
+  if (strings[1].empty() || *countEnd != '\0' || errno != 0 ||
+      envCount > strings.size() - 2) {
+    exit(EXIT_FAILURE);
+  }
+  clearenv();
+  for (unsigned long j{0}; j < envCount; ++j) {
+    putenv(strings[2 + j].data());
+  }
+  std::list<std::string> args(strings.begin() + 2 + envCount, strings.end());
+  residentContext = resident.context.get();
+  residentConfiguration = configuration;
+  moduleReportFd = reportFd;
+  std::int32_t status{RunDriver(std::move(args))};
+  WriteFully(connection, reinterpret_cast<char *>(&status), sizeof status);
+  exit(status);
+}
+
+// Whether a connected peer runs as the same user as this process
+bool IsSameUser(int connection) {
+  ucred peer;
+  socklen_t size{sizeof peer};
+  return getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &peer, &size) == 0 &&
+      peer.uid == geteuid();
+}
+
+// Whether something still accepts connections at a socket
+bool IsListening(const sockaddr_un &addr) {
+  int fd{socket(AF_UNIX, SOCK_STREAM, 0)};
+  if (fd < 0) {
+    return false;
+  }
+  bool listening{
+      connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) ==
+      0};
+  close(fd);
+  return listening;
+}
+
+static constexpr int stopSignals[]{SIGTERM, SIGINT, SIGHUP};
+static volatile std::sig_atomic_t stopServer{0};
+extern "C" void StopServer(int) { stopServer = 1; }
+
+void ServeClient(int connection, int listener, ResidentModules &resident,
+    const std::string &configuration, std::map<int, std::string> &reports) {
+  int report[2];
+  if (pipe2(report, O_CLOEXEC) != 0) {
+    close(connection);
+    return;
+  }
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+  pid_t pid{fork()};
+  if (pid == 0) {
+    for (int sig : stopSignals) {
+      signal(sig, SIG_DFL);
+    }
+    filesToDelete.clear();  // the socket belongs to the server
+    close(listener);
+    close(report[0]);
+    for (const auto &pair : reports) {
+      close(pair.first);
+    }
+    ReceiveRequest(connection, resident, configuration, report[1]);
+  }
+  close(report[1]);
+  close(connection);
+  if (pid < 0) {
+    close(report[0]);
+  } else {
+    reports.emplace(report[0], ""s);
+  }
+}
+
+int Serve(DriverOptions &driver, const Fortran::parser::Options &options,
+    const Fortran::common::IntrinsicTypeDefaultKinds &defaultKinds) {
+  sockaddr_un addr;
+  if (!MakeSocketAddress(driver.serverSocket.data(), addr)) {
+    std::cerr << driver.prefix << "socket path is too long: "
+              << driver.serverSocket << '\n';
+    return EXIT_FAILURE;
+  }
+  struct stat existing;
+  if (lstat(addr.sun_path, &existing) == 0) {
+    if (!S_ISSOCK(existing.st_mode)) {
+      std::cerr << driver.prefix << driver.serverSocket
+                << " exists and is not a socket\n";
+      return EXIT_FAILURE;
+    }
+    if (IsListening(addr)) {
+      std::cerr << driver.prefix << "a server is already listening on "
+                << driver.serverSocket << '\n';
+      return EXIT_FAILURE;
+    }
+    unlink(addr.sun_path);  // left behind by a server that is gone
+  }
+  int listener{socket(AF_UNIX, SOCK_STREAM, 0)};
+  mode_t oldMask{umask(0177)};  // the socket's mode is 0600
+  bool bound{listener >= 0 &&
+      bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof addr) == 0};
+  umask(oldMask);
+  if (!bound || listen(listener, SOMAXCONN) != 0) {
+    std::cerr << driver.prefix << "could not listen on "
+              << driver.serverSocket << ": " << std::strerror(errno) << '\n';
+    return EXIT_FAILURE;
+  }
+  filesToDelete.push_back(driver.serverSocket);
+  struct sigaction stop;
+  std::memset(&stop, 0, sizeof stop);
+  stop.sa_handler = StopServer;
+  sigemptyset(&stop.sa_mask);
+  for (int sig : stopSignals) {
+    sigaction(sig, &stop, nullptr);
+  }
+  std::string configuration{Configuration(driver, options, defaultKinds)};
+  ResidentModules resident;
+  MakeResidentContext(resident, options, driver, defaultKinds);
+  std::map<int, std::string> reports;  // module names from each worker
+  while (stopServer == 0) {
+    while (waitpid(-1, nullptr, WNOHANG) > 0) {
+    }
+    std::vector<pollfd> polls{{listener, POLLIN, 0}};
+    for (const auto &pair : reports) {
+      polls.push_back({pair.first, POLLIN, 0});
+    }
+    if (poll(polls.data(), polls.size(), 1000 /*ms*/) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << driver.prefix << "poll failed: " << std::strerror(errno)
+                << '\n';
+      return EXIT_FAILURE;
+    }
+    for (std::size_t j{1}; j < polls.size(); ++j) {
+      if (polls[j].revents == 0) {
+        continue;
+      }
+      int fd{polls[j].fd};
+      char buffer[4096];
+      ssize_t got{read(fd, buffer, sizeof buffer)};
+      if (got > 0) {
+        reports[fd].append(buffer, got);
+        continue;
+      }
+      std::set<std::string> names;
+      std::stringstream lines{reports[fd]};
+      for (std::string name; std::getline(lines, name);) {
+        names.insert(name);
+      }
+      close(fd);
+      reports.erase(fd);
+      LoadResidentModules(resident, names, options, driver, defaultKinds);
+    }
+    if ((polls[0].revents & POLLIN) != 0) {
+      int connection{accept(listener, nullptr, nullptr)};
+      if (connection >= 0 && !IsSameUser(connection)) {
+        close(connection);
+      } else if (connection >= 0) {
+        CheckResidentModules(resident, options, driver, defaultKinds);
+        ServeClient(connection, listener, resident, configuration, reports);
+      }
+    }
+  }
+  close(listener);
+  unlink(addr.sun_path);
+  while (waitpid(-1, nullptr, 0) > 0 || errno == EINTR) {
+  }
+  for (const auto &pair : reports) {
+    close(pair.first);
+  }
+  return EXIT_SUCCESS;
+}
+
 void Link(std::vector<std::string> &relocatables, DriverOptions &driver) {
   if (!ParentProcess()) {
     std::vector<char *> argv;
@@ -330,16 +1781,15 @@ void Link(std::vector<std::string> &relocatables, DriverOptions &driver) {
   }
 }
 
-int main(int argc, char *const argv[]) {
-
-  atexit(CleanUpAtExit);
-
+int RunDriver(std::list<std::string> args) {
   DriverOptions driver;
   const char *pgf90{getenv("F18_FC")};
+  if (const char *cacheDirectory{getenv("F18_CACHE_DIR")}) {
+    driver.cacheDirectory = cacheDirectory;
+  }
   driver.pgf90Args.push_back(pgf90 ? pgf90 : "pgf90");
   bool isPGF90{driver.pgf90Args.back().rfind("pgf90") != std::string::npos};
 
-  std::list<std::string> args{argList(argc, argv)};
   std::string prefix{args.front()};
   args.pop_front();
   prefix += ": ";
@@ -432,8 +1882,26 @@ int main(int argc, char *const argv[]) {
       driver.debugResolveNames = true;
     } else if (arg == "-fdebug-measure-parse-tree") {
       driver.measureTree = true;
+    } else if (arg.substr(0, 12) == "-fcache-dir=") {
+      driver.cacheDirectory = arg.substr(12);
+    } else if (arg == "-fbatch") {
+      driver.batch = true;
+    } else if (arg == "-fpipe-to-compiler") {
+      driver.pipeToCompiler = true;
+    } else if (arg == "-fno-pipe-to-compiler") {
+      driver.pipeToCompiler = false;
+    } else if (arg == "-ftime-report") {
+      driver.timeReport = true;
+    } else if (arg == "-ftime-report=json") {
+      driver.timeReport = driver.reportInJSON = true;
+    } else if (arg == "-fmemory-report") {
+      driver.memoryReport = countAllocations = true;
+    } else if (arg == "-fmemory-report=json") {
+      driver.memoryReport = driver.reportInJSON = countAllocations = true;
     } else if (arg == "-fdebug-instrumented-parse") {
       options.instrumentedParse = true;
+    } else if (arg.substr(0, 16) == "-fparse-threads=") {
+      options.parseThreads = std::max(1, atoi(arg.substr(16).data()));
     } else if (arg == "-fdebug-semantics") {
       // TODO: Enable by default once basic tests pass
       driver.debugSemantics = true;
@@ -445,11 +1913,32 @@ int main(int argc, char *const argv[]) {
       driver.unparseTypedExprsToPGF90 = true;
     } else if (arg == "-fparse-only") {
       driver.parseOnly = true;
+    } else if (arg == "-fmodule-order") {
+      driver.moduleOrder = true;
     } else if (arg == "-c") {
       driver.compileOnly = true;
+    } else if (arg.substr(0, 2) == "-j") {
+      std::string count{arg.substr(2)};
+      if (count.empty() && !args.empty() && !args.front().empty() &&
+          std::all_of(args.front().begin(), args.front().end(),
+              Fortran::parser::IsDecimalDigit)) {
+        count = args.front();
+        args.pop_front();
+      }
+      char *countEnd{nullptr};
+      long jobs{strtol(count.data(), &countEnd, 10)};
+      if (count.empty() || *countEnd != '\0' || jobs < 1 || jobs > 4096) {
+        std::cerr << driver.prefix << "-j needs a job count from 1 to 4096, "
+                  << "not '" << count << "'\n";
+        return EXIT_FAILURE;
+      }
+      driver.jobs = jobs;
     } else if (arg == "-o") {
       driver.outputPath = args.front();
       args.pop_front();
+    } else if (arg == "--server") {
+      driver.serverSocket = args.front();
+      args.pop_front();
     } else if (arg.substr(0, 2) == "-D") {
       auto eq{arg.find('=')};
       if (eq == std::string::npos) {
@@ -492,9 +1981,29 @@ int main(int argc, char *const argv[]) {
           << "  -flatin              interpret source as Latin-1 (ISO 8859-1) "
              "rather than UTF-8\n"
           << "  -fparse-only         parse only, no output except messages\n"
+          << "  -fparse-threads=N    parse the program units of a source "
+             "with N\n"
+          << "                       threads\n"
           << "  -funparse            parse & reformat only, no code "
              "generation\n"
           << "  -funparse-with-symbols  parse, resolve symbols, and unparse\n"
+          << "  -fmodule-order       compile sources in module dependence "
+             "order\n"
+          << "  -fcache-dir=dir      reuse front end results cached in dir "
+             "(also\n"
+          << "                       F18_CACHE_DIR)\n"
+          << "  -fbatch              share intrinsic tables and modules "
+             "among the\n"
+          << "                       compilations of many sources\n"
+          << "  -f[no-]pipe-to-compiler  pipe the unparsed source to the "
+             "compiler's\n"
+          << "                       standard input (default for gfortran)\n"
+          << "  -ftime-report[=json] report the time spent in each "
+             "compilation phase\n"
+          << "  -fmemory-report[=json] report the memory allocated in each "
+             "phase\n"
+          << "                       and the sizes of the principal data "
+             "structures\n"
           << "  -fdebug-measure-parse-tree\n"
           << "  -fdebug-dump-provenance\n"
           << "  -fdebug-dump-parse-tree\n"
@@ -502,6 +2011,16 @@ int main(int argc, char *const argv[]) {
           << "  -fdebug-resolve-names\n"
           << "  -fdebug-instrumented-parse\n"
           << "  -fdebug-semantics    perform semantic checks\n"
+          << "  -j N                 compile up to N Fortran sources at once; "
+             "a source\n"
+          << "                       that uses a module defined by an "
+             "earlier one\n"
+          << "                       waits for it\n"
+          << "  --server socket      run as a compile server for clients "
+             "that set\n"
+          << "                       F18_SERVER=socket, keeping their "
+             "modules resident;\n"
+          << "                       stop it with SIGTERM or SIGINT\n"
           << "  -v -c -o -I -D -U    have their usual meanings\n"
           << "  -help                print this again\n"
           << "Other options are passed through to the compiler.\n";
@@ -538,15 +2057,59 @@ int main(int argc, char *const argv[]) {
   } else {
     // TODO: equivalents for other Fortran compilers
   }
+  if (!driver.pipeToCompiler.has_value()) {
+    // gfortran can read source from a pipe; pgf90 needs a file.
+    driver.pipeToCompiler =
+        driver.pgf90Args.front().rfind("gfortran") != std::string::npos;
+  }
+
+  if (!driver.serverSocket.empty()) {
+    return Serve(driver, options, defaultKinds);
+  }
+  if (residentContext != nullptr &&
+      Configuration(driver, options, defaultKinds) != residentConfiguration) {
+    residentContext = nullptr;
+  }
 
   if (!anyFiles) {
     driver.measureTree = true;
     driver.dumpUnparse = true;
     CompileFortran("-", options, driver, defaultKinds);
+    EmitPhaseReport(driver);
     return exitStatus;
   }
-  for (const auto &path : fortranSources) {
-    std::string relo{CompileFortran(path, options, driver, defaultKinds)};
+  ResidentModules batch;
+  if (driver.batch && residentContext == nullptr &&
+      fortranSources.size() > 1) {
+    MakeResidentContext(batch, options, driver, defaultKinds);
+    batchModules = &batch;
+    for (const char *name : intrinsicModules) {
+      if (HasModuleFile(name, driver)) {
+        batch.reported.insert(name);
+      }
+    }
+    UpdateBatchModules(options, driver, defaultKinds);
+  }
+  std::vector<std::string> fortranRelocatables;
+  if (driver.moduleOrder || driver.jobs > 1) {
+    fortranRelocatables.resize(fortranSources.size());
+    for (const auto &wave :
+        ScheduleByModuleDependences(fortranSources, options, driver)) {
+      std::vector<std::string> paths;
+      for (std::size_t j : wave) {
+        paths.push_back(fortranSources[j]);
+      }
+      std::vector<std::string> relos{
+          CompileFortranSources(paths, options, driver, defaultKinds)};
+      for (std::size_t j{0}; j < wave.size(); ++j) {
+        fortranRelocatables[wave[j]] = std::move(relos[j]);
+      }
+    }
+  } else {
+    fortranRelocatables =
+        CompileFortranSources(fortranSources, options, driver, defaultKinds);
+  }
+  for (const std::string &relo : fortranRelocatables) {
     if (!driver.compileOnly && !relo.empty()) {
       relocatables.push_back(relo);
     }
@@ -560,5 +2123,21 @@ int main(int argc, char *const argv[]) {
   if (!relocatables.empty()) {
     Link(relocatables, driver);
   }
+  EmitPhaseReport(driver);
   return exitStatus;
 }
+
+int main(int argc, char *const argv[]) {
+
+  atexit(CleanUpAtExit);
+
+  std::list<std::string> args{argList(argc, argv)};
+  if (const char *server{getenv("F18_SERVER")}) {
+    if (std::find(args.begin(), args.end(), "--server") == args.end()) {
+      if (std::optional<int> status{ForwardToServer(server, args)}) {
+        return *status;
+      }
+    }
+  }
+  return RunDriver(std::move(args));
+}